@@ -0,0 +1,17 @@
+# Writes SF_BUILD_ID_OUT, a C file defining SF_COMPILER_BUILD_ID.
+# SF_BUILD_ID_LIST: first line describes the toolchain, every further line is an input file.
+file(STRINGS "${SF_BUILD_ID_LIST}" lines)
+set(digest "")
+foreach(line IN LISTS lines)
+    if(EXISTS "${line}" AND NOT IS_DIRECTORY "${line}")
+        file(SHA256 "${line}" file_hash)
+        string(APPEND digest "${file_hash}")
+    else()
+        string(APPEND digest "${line}")
+    endif()
+endforeach()
+string(SHA256 build_id "${digest}")
+
+file(WRITE "${SF_BUILD_ID_OUT}"
+    "/* Generated by sf_build_id.cmake: hash of the compiler sources and toolchain */\n"
+    "const char SF_COMPILER_BUILD_ID[] = \"${build_id}\";\n")
@@ -19,6 +19,7 @@ typedef struct {
     uint32_t error_count;
     uint32_t error_capacity;
     bool has_error;
+    bool muted; // Collect without logging (speculative passes replay on success)
 } sf_compiler_diag;
 
 void sf_compiler_diag_init(sf_compiler_diag* diag, sf_arena* arena);
@@ -31,7 +32,10 @@ typedef struct sf_json_value sf_json_value;
 // Node metadata and opcodes are provided by SionFlow ISA
 #include <sionflow/isa/sf_opcodes.h>
 
-// --- Fusion Rules ---
+// --- Fusion Rules (deprecated) ---
+// Single-level view of the fusion rules, kept for existing consumers of this header. The
+// compiler matches the nested patterns of compiler_spec.json instead; rules deeper than one
+// absorbed node (or with more than two alternatives) are left out of this table.
 typedef struct {
     const char* port_name;
     sf_node_type match_type;
@@ -152,15 +156,103 @@ bool sf_compiler_load_manifest(const char* path, sf_compiler_manifest* out_manif
 
 // --- Compiler Interface ---
 
-// 1. Parse JSON -> IR
+// 1. Parse JSON -> IR (.sfir files are loaded as binary IR)
 bool sf_compile_load_json(const char* json_path, sf_graph_ir* out_ir, sf_arena* arena, sf_compiler_diag* diag);
 
+// Binary IR (.sfir): a lowered graph that loads without parsing, e.g. a precompiled
+// subgraph library. Imports and CALL paths may name .sfir files wherever JSON is accepted.
+bool sf_compile_save_ir(const sf_graph_ir* ir, const char* path);
+bool sf_compile_load_ir(const char* path, sf_graph_ir* out_ir, sf_arena* arena, sf_compiler_diag* diag);
+
 // 2. IR -> Program (Autonomous Compilation)
+// Reentrant: all pass state lives in a per-call context and the caller's arena, so
+// independent kernels may be compiled concurrently given separate arenas and diagnostics.
 sf_program* sf_compile(sf_graph_ir* ir, sf_arena* arena, sf_compiler_diag* diag);
 
+// --- Compiler Options ---
+
+#define SF_DEFAULT_TENSOR_ALIGNMENT 64
+#define SF_DEFAULT_L1_CACHE_BYTES (32u * 1024u)
+#define SF_DEFAULT_L2_CACHE_BYTES (1024u * 1024u)
+#define SF_DEFAULT_FOLD_MAX_BYTES (16u * 1024u)
+
+typedef enum {
+    SF_SCHEDULE_CLUSTER = 0,    // Fewest task breaks: group nodes by domain and strategy
+    SF_SCHEDULE_MIN_MEMORY = 1, // Lowest peak of live intermediate bytes
+} sf_schedule_mode;
+
+typedef struct {
+    u32 tensor_alignment; // Byte alignment of planned tensors (power of two)
+    sf_schedule_mode schedule;
+    u32 l1_cache_bytes;   // Tiling budget: working set of one tile across all its bindings
+    u32 l2_cache_bytes;   // Upper bound for rows that cannot be split to fit l1_cache_bytes
+    u32 fold_max_bytes;   // Largest constant folding may create (0 disables folding)
+    bool strict_fp;       // Keep F32 results bit-exact: no reassociation or inexact algebra
+} sf_compiler_options;
+
+void sf_compiler_options_init(sf_compiler_options* opts);
+
+// --- Memory Plan ---
+// Static layout of every runtime tensor inside one contiguous buffer, so a program
+// instance needs a single allocation. Registers that do not live in that buffer
+// (constants, INPUT/OUTPUT aliases, dynamic shapes) are SF_MEMORY_UNPLANNED.
+
+#define SF_MEMORY_UNPLANNED UINT64_MAX
+
+typedef struct {
+    u64 arena_size;
+    u32 alignment;
+    u32 tensor_count; // Matches program meta.tensor_count
+    u64* offsets;     // Per register
+} sf_memory_plan;
+
+typedef struct {
+    sf_program* program;
+    sf_memory_plan memory;
+    u64 peak_live_bytes; // Intermediate bytes live at once in the chosen schedule
+} sf_compile_result;
+
+// 'opts' may be NULL for defaults. sf_compile is the same call without the extra results.
+bool sf_compile_ex(sf_graph_ir* ir, const sf_compiler_options* opts, sf_arena* arena, sf_compiler_diag* diag, sf_compile_result* out);
+
+// Flat blob ("SFMP" header followed by the offsets) for embedding as a RAW section
+void* sf_memory_plan_serialize(const sf_memory_plan* plan, sf_arena* arena, u32* out_size);
+
 // 3. Save Program
 bool sf_compile_save_program(const sf_program* prog, const char* path);
 
 bool sf_compile_save_cartridge(const char* path, const sf_graph_ir* ir, const sf_section_desc* sections, u32 section_count);
 
+// --- Shared Constants ---
+// With 'share_constants', CONST payloads that occur more than once across the program sections
+// are stored once in a single RAW "constants" section, which also holds a table of pool indices
+// for every program that references it (layout in sf_const_pool.c). Those programs are written
+// without the pooled payloads, so a loader must call sf_const_pool_resolve on each of them.
+// 'arena' holds the pool until the file is written; 'out_stats' may be NULL.
+
+typedef struct {
+    u32 constant_count;   // CONST tensors across all programs
+    u32 shared_count;     // Of those, tensors that now reference the pool
+    u32 pool_entry_count; // Distinct payloads in the pool
+    u64 bytes_before;     // Constant bytes stored per program
+    u64 bytes_after;      // Constant bytes with the pool (inline + pool payloads)
+} sf_const_pool_stats;
+
+bool sf_compile_save_cartridge_ex(const char* path, const sf_graph_ir* ir, const sf_section_desc* sections, u32 section_count, bool share_constants, sf_arena* arena, sf_const_pool_stats* out_stats);
+
+// Points the pooled tensors of 'prog' (the program section named 'program_name') into the loaded
+// "constants" section, which must outlive the program. Programs without a table are left as they
+// are. Returns false on a corrupt pool or a table that does not match the program.
+bool sf_const_pool_resolve(const void* pool, size_t pool_size, const char* program_name, sf_program* prog);
+
+// --- Compilation Cache ---
+// Content-addressed on-disk store of compiled kernels. The key covers the kernel JSON,
+// every transitively imported subgraph, the compiler options, compiler_spec.json, the ISA layout
+// and the compiler build (a hash of its sources taken at build time).
+// 'settings' carries the app settings (window, title) of the graph alongside the program.
+
+bool sf_compile_cache_key(const char* json_path, const sf_compiler_options* opts, sf_arena* arena, u64* out_key);
+bool sf_compile_cache_load(const char* cache_dir, u64 key, sf_graph_ir* out_settings, sf_arena* arena, sf_compile_result* out);
+bool sf_compile_cache_store(const char* cache_dir, u64 key, const sf_compile_result* result, const sf_graph_ir* settings);
+
 #endif // SF_COMPILER_H
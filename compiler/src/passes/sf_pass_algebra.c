@@ -0,0 +1,204 @@
+#include "../sf_passes.h"
+#include "../sf_graph_utils.h"
+#include "../sf_compiler_internal.h"
+#include <sionflow/base/sf_log.h>
+#include <sionflow/base/sf_shape.h>
+#include <math.h>
+#include <string.h>
+
+/**
+ * Algebraic Simplification Pass
+ * Applies the 'algebraic_rules' from compiler_spec.json (identities, absorbing elements,
+ * division by constants) in topological order, so a
+ * rewrite is visible to every consumer further down. Needs analyzed shapes: a rewrite never
+ * changes the shape or dtype a consumer sees. Under options->strict_fp only rewrites that are
+ * bit-exact for F32 are applied.
+ */
+
+typedef struct {
+    const sf_algebraic_rule* rule;
+    sf_node_type op;
+    sf_node_type with;
+    u32 port; // UINT32_MAX: any port
+} sf_algebra_active_rule;
+
+static u32 find_port(sf_node_type type, const char* name) {
+    if (!name) return UINT32_MAX;
+    for (u32 i = 0; i < 4; ++i) {
+        if (SF_OP_METADATA[type].ports[i] && strcmp(SF_OP_METADATA[type].ports[i], name) == 0) return i;
+    }
+    return UINT32_MAX;
+}
+
+static bool same_info(const sf_type_info* a, const sf_type_info* b) {
+    return a->dtype == b->dtype && a->ndim == b->ndim &&
+           memcmp(a->shape, b->shape, sizeof(a->shape[0]) * a->ndim) == 0;
+}
+
+static size_t const_count(const sf_ir_node* node) {
+    return sf_shape_calc_count(node->const_info.shape, node->const_info.ndim);
+}
+
+static f64 const_elem(const sf_ir_node* node, size_t i) {
+    switch (node->const_info.dtype) {
+        case SF_DTYPE_F32: return (f64)((const f32*)node->const_data)[i];
+        case SF_DTYPE_I32: return (f64)((const i32*)node->const_data)[i];
+        case SF_DTYPE_U8:  return (f64)((const u8*)node->const_data)[i];
+        default: return 0.0;
+    }
+}
+
+// CONST whose elements all equal 'value'
+static bool const_is_splat(const sf_ir_node* node, f64 value) {
+    if (!node || node->type != SF_NODE_CONST || !node->const_data) return false;
+    size_t count = const_count(node);
+    if (count == 0) return false;
+    for (size_t i = 0; i < count; ++i) if (const_elem(node, i) != value) return false;
+    return true;
+}
+
+// 1/v is exact only for normal powers of two
+static bool has_exact_reciprocal(f32 v) {
+    u32 bits;
+    memcpy(&bits, &v, sizeof(bits));
+    u32 exponent = (bits >> 23) & 0xFF;
+    return (bits & 0x7FFFFF) == 0 && exponent != 0 && exponent < 253;
+}
+
+// Redirects every consumer of 'node_idx' to 'value_idx' and drops the node
+static void forward_to(sf_graph_ir* ir, u32 node_idx, u32 value_idx) {
+    sf_builder_replace_node(ir, node_idx, value_idx);
+    sf_builder_remove_node(ir, node_idx);
+}
+
+// Turns the node into a 'type' node reading (a, b). Index and consumers stay the same.
+static void rewrite_binary(sf_graph_ir* ir, sf_arena* arena, u32 node_idx, sf_node_type type, sf_port a, sf_port b) {
+    for (u32 k = 0; k < 4; ++k) sf_builder_disconnect(ir, (sf_port){ node_idx, k });
+    ir->nodes[node_idx].type = type;
+    sf_builder_connect(ir, arena, a, (sf_port){ node_idx, find_port(type, "a") });
+    sf_builder_connect(ir, arena, b, (sf_port){ node_idx, find_port(type, "b") });
+}
+
+static bool apply_rule(sf_graph_ir* ir, sf_arena* arena, u32 node_idx, const sf_algebra_active_rule* ar, u64 max_const_bytes, bool strict_fp) {
+    const sf_algebraic_rule* rule = ar->rule;
+    const sf_ir_node* node = &ir->nodes[node_idx];
+
+    // Binary rules: 'c' is a constant operand, 'x' the other one
+    for (u32 cp = 0; cp < 2; ++cp) {
+        if (ar->port != UINT32_MAX && ar->port != cp) continue;
+        sf_port c = sf_builder_get_source(ir, (sf_port){ node_idx, cp });
+        sf_port x = sf_builder_get_source(ir, (sf_port){ node_idx, 1 - cp });
+        if (SF_PORT_IS_NULL(c) || SF_PORT_IS_NULL(x)) continue;
+        const sf_ir_node* cn = &ir->nodes[c.node_idx];
+        const sf_ir_node* xn = &ir->nodes[x.node_idx];
+
+        switch (rule->kind) {
+            case SF_ALGEBRA_IDENTITY:
+                if (!const_is_splat(cn, rule->constant) || !same_info(&xn->out_info, &node->out_info)) break;
+                // -0 + 0 is +0: additive identities are not bit-exact for F32
+                if (strict_fp && node->out_info.dtype == SF_DTYPE_F32 && rule->constant == 0) break;
+                forward_to(ir, node_idx, x.node_idx);
+                return true;
+
+            case SF_ALGEBRA_ABSORB: {
+                if (!const_is_splat(cn, rule->constant)) break;
+                if (strict_fp && node->out_info.dtype == SF_DTYPE_F32) break; // NaN * 0 is NaN
+                if (same_info(&cn->out_info, &node->out_info)) {
+                    forward_to(ir, node_idx, c.node_idx);
+                    return true;
+                }
+                // The constant broadcasts: materialize it at the result's shape
+                const sf_type_info* out = &node->out_info;
+                for (u8 d = 0; d < out->ndim; ++d) if (out->shape[d] <= 0) return false;
+                size_t count = sf_shape_calc_count(out->shape, out->ndim);
+                u64 bytes = (u64)count * sf_dtype_size(out->dtype);
+                if (bytes == 0 || bytes > max_const_bytes) break;
+                f64 value = rule->constant;
+                void* data = SF_ARENA_PUSH(arena, u8, bytes);
+                for (size_t i = 0; i < count; ++i) {
+                    if (out->dtype == SF_DTYPE_F32) ((f32*)data)[i] = (f32)value;
+                    else if (out->dtype == SF_DTYPE_I32) ((i32*)data)[i] = (i32)value;
+                    else if (out->dtype == SF_DTYPE_U8) ((u8*)data)[i] = (u8)value;
+                    else return false;
+                }
+                for (u32 k = 0; k < 4; ++k) sf_builder_disconnect(ir, (sf_port){ node_idx, k });
+                sf_ir_node* n = &ir->nodes[node_idx];
+                n->type = SF_NODE_CONST;
+                n->const_info = n->out_info;
+                n->const_data = data;
+                return true;
+            }
+
+            case SF_ALGEBRA_RECIPROCAL: {
+                // Integer division does not have a reciprocal
+                if (ar->with == SF_NODE_UNKNOWN || node->out_info.dtype != SF_DTYPE_F32) break;
+                if (!cn || cn->type != SF_NODE_CONST || !cn->const_data || cn->const_info.dtype != SF_DTYPE_F32) break;
+                size_t count = const_count(cn);
+                f32* recip = SF_ARENA_PUSH(arena, f32, count ? count : 1);
+                bool ok = count > 0;
+                // x * (1/c) only matches x / c while 1/c is a normal number: zeros, infinities,
+                // NaNs and subnormal reciprocals (flushed or imprecise) keep the division
+                for (size_t i = 0; i < count && ok; ++i) {
+                    f32 v = ((const f32*)cn->const_data)[i];
+                    recip[i] = 1.0f / v;
+                    ok = isnormal(recip[i]) && (!strict_fp || has_exact_reciprocal(v));
+                }
+                if (!ok || !sf_ir_graph_reserve(ir, arena, 1)) break;
+                sf_ir_node* rn = sf_ir_node_add(ir, arena, sf_arena_sprintf(arena, "%s_recip", ir->nodes[c.node_idx].id), SF_NODE_CONST);
+                cn = &ir->nodes[c.node_idx];
+                rn->loc = cn->loc;
+                rn->const_info = cn->const_info;
+                rn->out_info = cn->out_info;
+                rn->const_data = recip;
+                rewrite_binary(ir, arena, node_idx, ar->with, x, (sf_port){ (u32)(rn - ir->nodes), 0 });
+                return true;
+            }
+
+            default:
+                break;
+        }
+    }
+    return false;
+}
+
+bool sf_pass_algebra(sf_pass_ctx* ctx, sf_compiler_diag* diag) {
+    sf_graph_ir* ir = ctx->ir;
+    sf_arena* arena = ctx->arena;
+    if (SF_ALGEBRAIC_RULE_COUNT == 0 || !ctx->sorted_nodes) return true;
+
+    // Resolve op names once; rules naming ops outside the ISA stay inactive
+    sf_algebra_active_rule* rules = SF_ARENA_PUSH(arena, sf_algebra_active_rule, SF_ALGEBRAIC_RULE_COUNT);
+    u32 rule_count = 0;
+    for (size_t r = 0; r < SF_ALGEBRAIC_RULE_COUNT; ++r) {
+        const sf_algebraic_rule* rule = &SF_ALGEBRAIC_RULES[r];
+        sf_node_type op = sf_compiler_get_node_type(rule->op);
+        if (op == SF_NODE_UNKNOWN) continue;
+        sf_algebra_active_rule* ar = &rules[rule_count++];
+        ar->rule = rule;
+        ar->op = op;
+        ar->with = rule->with ? sf_compiler_get_node_type(rule->with) : SF_NODE_UNKNOWN;
+        ar->port = find_port(op, rule->port);
+    }
+    if (rule_count == 0) return true;
+
+    // Node indices, not pointers: rewrites may grow (and move) the node array
+    size_t count = ctx->sorted_count;
+    u32* order = SF_ARENA_PUSH(arena, u32, count ? count : 1);
+    for (size_t i = 0; i < count; ++i) order[i] = (u32)(ctx->sorted_nodes[i] - ir->nodes);
+
+    u64 max_const_bytes = ctx->options ? ctx->options->fold_max_bytes : SF_DEFAULT_FOLD_MAX_BYTES;
+    bool strict_fp = ctx->options && ctx->options->strict_fp;
+    u32 rewritten = 0;
+    for (size_t i = 0; i < count; ++i) {
+        u32 idx = order[i];
+        for (u32 r = 0; r < rule_count; ++r) {
+            if (ir->nodes[idx].type != rules[r].op) continue;
+            if (apply_rule(ir, arena, idx, &rules[r], max_const_bytes, strict_fp)) { rewritten++; break; }
+        }
+    }
+
+    if (rewritten == 0) return true;
+    SF_LOG_DEBUG("Algebraic Simplification: %u rewrites", rewritten);
+    // New nodes are not in the order yet and old pointers may be stale
+    return sf_pass_sort(ctx, diag);
+}
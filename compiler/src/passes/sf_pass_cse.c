@@ -0,0 +1,122 @@
+#include "../sf_passes.h"
+#include "../sf_graph_utils.h"
+#include "../sf_compiler_internal.h"
+#include <sionflow/base/sf_log.h>
+#include <sionflow/base/sf_shape.h>
+#include <string.h>
+
+/**
+ * Common Subexpression Elimination Pass
+ * Hash-consing over the IR in topological order: two nodes are the same value when they
+ * have the same type, attributes and (already canonical) inputs. Inputs of COMMUTATIVE ops
+ * are compared as an unordered pair, constants by their contents. Every duplicate is
+ * merged into the first equivalent node and removed.
+ */
+
+// Nodes that stand for more than their operands: graph ports, stateful resources and
+// generators (their values depend on the domain they end up in).
+static bool is_mergeable(const sf_ir_node* node) {
+    if (node->type == SF_NODE_UNKNOWN || node->type == SF_NODE_INPUT ||
+        node->type == SF_NODE_OUTPUT || node->type == SF_NODE_CALL) return false;
+    if (node->resource_flags) return false;
+    return (SF_COMPILER_NODE_TRAITS[node->type] & SF_NODE_TRAIT_GENERATOR) == 0;
+}
+
+static size_t const_bytes(const sf_ir_node* node) {
+    if (!node->const_data) return 0;
+    return sf_shape_calc_count(node->const_info.shape, node->const_info.ndim) * sf_dtype_size(node->const_info.dtype);
+}
+
+// Input ports in canonical order: the first two operands of commutative ops are sorted
+static void canonical_inputs(const sf_ir_node* node, u32 out[4][2]) {
+    for (u32 p = 0; p < 4; ++p) {
+        out[p][0] = node->inputs[p].src_node_idx;
+        out[p][1] = node->inputs[p].src_node_idx == UINT32_MAX ? 0 : node->inputs[p].src_port_idx;
+    }
+    if (SF_COMPILER_NODE_TRAITS[node->type] & SF_NODE_TRAIT_COMMUTATIVE) {
+        if (out[1][0] < out[0][0] || (out[1][0] == out[0][0] && out[1][1] < out[0][1])) {
+            u32 n = out[0][0], p = out[0][1];
+            out[0][0] = out[1][0]; out[0][1] = out[1][1];
+            out[1][0] = n; out[1][1] = p;
+        }
+    }
+}
+
+static bool same_info(const sf_type_info* a, const sf_type_info* b) {
+    return a->dtype == b->dtype && a->ndim == b->ndim &&
+           memcmp(a->shape, b->shape, sizeof(a->shape[0]) * a->ndim) == 0;
+}
+
+static u64 hash_node(const sf_ir_node* node) {
+    u32 inputs[4][2];
+    canonical_inputs(node, inputs);
+    u32 type = (u32)node->type;
+    u64 h = sf_hash64(&type, sizeof(type), SF_HASH64_SEED);
+    h = sf_hash64(inputs, sizeof(inputs), h);
+    h = sf_hash64(&node->const_info.ndim, sizeof(node->const_info.ndim), h);
+    h = sf_hash64(node->const_info.shape, sizeof(node->const_info.shape[0]) * node->const_info.ndim, h);
+    if (node->type == SF_NODE_CONST) h = sf_hash64(node->const_data, const_bytes(node), h);
+    return h;
+}
+
+static bool nodes_equal(const sf_ir_node* a, const sf_ir_node* b) {
+    if (a->type != b->type) return false;
+    u32 ia[4][2], ib[4][2];
+    canonical_inputs(a, ia);
+    canonical_inputs(b, ib);
+    if (memcmp(ia, ib, sizeof(ia)) != 0) return false;
+    // Attributes from the source graph ('shape', 'dtype') live in const_info/out_info
+    if (!same_info(&a->const_info, &b->const_info) || !same_info(&a->out_info, &b->out_info)) return false;
+    if (a->type == SF_NODE_CONST) {
+        size_t size = const_bytes(a);
+        if (size != const_bytes(b)) return false;
+        if (size && memcmp(a->const_data, b->const_data, size) != 0) return false;
+        if (!size && (a->const_data != NULL) != (b->const_data != NULL)) return false;
+    }
+    return true;
+}
+
+bool sf_pass_cse(sf_pass_ctx* ctx, sf_compiler_diag* diag) {
+    sf_graph_ir* ir = ctx->ir;
+    sf_arena* arena = ctx->arena;
+    u32 node_count = (u32)ir->node_count;
+    if (node_count < 2) return true;
+
+    // Producers first, so every input is already the surviving representative when hashed
+    u32* order = SF_ARENA_PUSH(arena, u32, node_count);
+    if (!sf_ir_graph_sort(ir, order, arena, diag)) return false;
+
+    u32 table_size = 16;
+    while (table_size < node_count * 2) table_size *= 2;
+    u32 mask = table_size - 1;
+    u32* slots = SF_ARENA_PUSH(arena, u32, table_size);
+    u64* hashes = SF_ARENA_PUSH(arena, u64, table_size);
+    for (u32 i = 0; i < table_size; ++i) slots[i] = UINT32_MAX;
+
+    u32 merged = 0;
+    for (u32 i = 0; i < node_count; ++i) {
+        u32 idx = order[i];
+        sf_ir_node* node = &ir->nodes[idx];
+        if (!is_mergeable(node)) continue;
+
+        u64 h = hash_node(node);
+        u32 slot = (u32)(h & mask);
+        u32 rep = UINT32_MAX;
+        while (slots[slot] != UINT32_MAX) {
+            if (hashes[slot] == h && nodes_equal(&ir->nodes[slots[slot]], node)) { rep = slots[slot]; break; }
+            slot = (slot + 1) & mask;
+        }
+
+        if (rep == UINT32_MAX) {
+            slots[slot] = idx;
+            hashes[slot] = h;
+            continue;
+        }
+        sf_builder_replace_node(ir, idx, rep);
+        sf_builder_remove_node(ir, idx);
+        merged++;
+    }
+
+    if (merged > 0) SF_LOG_DEBUG("CSE: merged %u duplicate nodes", merged);
+    return true;
+}
@@ -0,0 +1,90 @@
+#include "../sf_passes.h"
+#include "../sf_graph_utils.h"
+#include <sionflow/base/sf_log.h>
+#include <string.h>
+
+/**
+ * Dead Code Elimination Pass
+ * Mark and sweep: everything an OUTPUT, a persistent resource or a graph INPUT (kept so the
+ * host can still bind it by name) transitively reads is live, the rest is removed.
+ * Afterwards the node array is compacted so removed and earlier tombstoned nodes no longer
+ * take up slots. Later passes (registers, instructions) then only see live values.
+ */
+
+static bool is_root(const sf_ir_node* node) {
+    return node->type == SF_NODE_OUTPUT || node->type == SF_NODE_INPUT ||
+           (node->resource_flags & SF_RESOURCE_FLAG_PERSISTENT);
+}
+
+// Closes the gaps left by UNKNOWN nodes and rewrites every index that refers to a node
+static void compact_nodes(sf_graph_ir* ir, sf_arena* arena) {
+    u32 count = (u32)ir->node_count;
+    u32* remap = SF_ARENA_PUSH(arena, u32, count);
+    u32 live = 0;
+    for (u32 i = 0; i < count; ++i) {
+        remap[i] = (ir->nodes[i].type == SF_NODE_UNKNOWN) ? UINT32_MAX : live++;
+    }
+    if (live == count) return;
+
+    for (u32 i = 0; i < count; ++i) {
+        if (remap[i] == UINT32_MAX) continue;
+        if (remap[i] != i) ir->nodes[remap[i]] = ir->nodes[i];
+        sf_ir_node* node = &ir->nodes[remap[i]];
+        for (u32 p = 0; p < 4; ++p) {
+            u32 src = node->inputs[p].src_node_idx;
+            if (src != UINT32_MAX) node->inputs[p].src_node_idx = remap[src];
+        }
+        // Entries of consumers that were removed without being disconnected are dropped
+        for (sf_ir_user** u = &node->users; *u;) {
+            if (remap[(*u)->node_idx] == UINT32_MAX) { *u = (*u)->next; continue; }
+            (*u)->node_idx = remap[(*u)->node_idx];
+            u = &(*u)->next;
+        }
+        if (node->domain_node_idx != UINT32_MAX && node->domain_node_idx < count) node->domain_node_idx = remap[node->domain_node_idx];
+    }
+    memset(&ir->nodes[live], 0, sizeof(sf_ir_node) * (count - live));
+    ir->node_count = live;
+}
+
+bool sf_pass_dce(sf_pass_ctx* ctx, sf_compiler_diag* diag) {
+    sf_graph_ir* ir = ctx->ir;
+    sf_arena* arena = ctx->arena;
+    u32 count = (u32)ir->node_count;
+    if (count == 0) return true;
+
+    // 1. Mark from the roots through inputs (and domain representatives, which tasks read)
+    u8* live = SF_ARENA_PUSH(arena, u8, count);
+    u32* stack = SF_ARENA_PUSH(arena, u32, count);
+    memset(live, 0, count);
+    u32 top = 0;
+    for (u32 i = 0; i < count; ++i) {
+        if (ir->nodes[i].type != SF_NODE_UNKNOWN && is_root(&ir->nodes[i])) { live[i] = 1; stack[top++] = i; }
+    }
+    while (top > 0) {
+        const sf_ir_node* node = &ir->nodes[stack[--top]];
+        u32 deps[5] = { node->inputs[0].src_node_idx, node->inputs[1].src_node_idx,
+                        node->inputs[2].src_node_idx, node->inputs[3].src_node_idx, node->domain_node_idx };
+        for (u32 k = 0; k < 5; ++k) {
+            u32 d = deps[k];
+            if (d >= count || live[d] || ir->nodes[d].type == SF_NODE_UNKNOWN) continue;
+            live[d] = 1;
+            stack[top++] = d;
+        }
+    }
+
+    // 2. Sweep
+    u32 removed = 0;
+    for (u32 i = 0; i < count; ++i) {
+        if (live[i] || ir->nodes[i].type == SF_NODE_UNKNOWN) continue;
+        sf_builder_remove_node(ir, i);
+        removed++;
+    }
+
+    // 3. Tombstone cleanup. Node pointers from an earlier sort are stale afterwards, so the
+    // order is rebuilt when this runs late in the pipeline.
+    compact_nodes(ir, arena);
+    if (ctx->sorted_nodes && !sf_pass_sort(ctx, diag)) return false;
+
+    if (removed > 0) SF_LOG_DEBUG("DCE: removed %u dead nodes", removed);
+    return true;
+}
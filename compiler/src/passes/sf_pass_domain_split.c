@@ -1,4 +1,5 @@
 #include "sf_passes.h"
+#include "../sf_compiler_internal.h"
 #include <sionflow/base/sf_log.h>
 #include <sionflow/base/sf_shape.h>
 #include <string.h>
@@ -23,49 +24,77 @@ static bool can_broadcast_to(const sf_type_info* src, const sf_type_info* dst) {
     return true;
 }
 
-static void mark_domain(sf_graph_ir* ir, u32 node_idx, u32 domain_idx) {
+// Assigns 'domain_idx' to the node and every unassigned node it (transitively) reads
+static void mark_domain(sf_graph_ir* ir, u32 node_idx, u32 domain_idx, u32* stack) {
     if (node_idx == UINT32_MAX || ir->nodes[node_idx].domain_node_idx != UINT32_MAX) return;
 
+    // Explicit stack: nodes are marked when pushed, so each one enters it at most once
+    u32 top = 0;
     ir->nodes[node_idx].domain_node_idx = domain_idx;
-
-    // Recurse to inputs using O(1) connectivity
-    sf_ir_node* node = &ir->nodes[node_idx];
-    for (int p = 0; p < 4; ++p) {
-        u32 src_idx = node->inputs[p].src_node_idx;
-        if (src_idx != UINT32_MAX) {
-            mark_domain(ir, src_idx, domain_idx);
+    stack[top++] = node_idx;
+    while (top > 0) {
+        sf_ir_node* node = &ir->nodes[stack[--top]];
+        for (int p = 0; p < 4; ++p) {
+            u32 src_idx = node->inputs[p].src_node_idx;
+            if (src_idx != UINT32_MAX && ir->nodes[src_idx].domain_node_idx == UINT32_MAX) {
+                ir->nodes[src_idx].domain_node_idx = domain_idx;
+                stack[top++] = src_idx;
+            }
         }
     }
 }
 
+static u64 hash_shape(const sf_type_info* info) {
+    u64 h = sf_hash64(&info->ndim, sizeof(info->ndim), SF_HASH64_SEED);
+    return sf_hash64(info->shape, sizeof(info->shape[0]) * info->ndim, h);
+}
+
+// Open-addressing table of domain representatives, one per distinct shape
+typedef struct {
+    u32* slots;
+    u32 mask;
+} sf_domain_table;
+
+// Returns the representative for the node's shape, registering the node if there is none yet
+static u32 domain_table_find_or_add(sf_domain_table* t, const sf_graph_ir* ir, u32 node_idx) {
+    const sf_type_info* info = &ir->nodes[node_idx].out_info;
+    u32 slot = (u32)(hash_shape(info) & t->mask);
+    while (t->slots[slot] != UINT32_MAX) {
+        u32 rep = t->slots[slot];
+        if (shapes_equal(&ir->nodes[rep].out_info, info)) return rep;
+        slot = (slot + 1) & t->mask;
+    }
+    t->slots[slot] = node_idx;
+    return node_idx;
+}
+
 bool sf_pass_domain_split(sf_pass_ctx* ctx, sf_compiler_diag* diag) {
     sf_graph_ir* ir = ctx->ir;
     if (!ir) {
         SF_REPORT(diag, NULL, "Domain Split Pass: IR is NULL");
         return false;
     }
+    if (ir->node_count == 0) return true;
 
     // 1. Reset all domain indices
     for (size_t i = 0; i < ir->node_count; ++i) {
         ir->nodes[i].domain_node_idx = UINT32_MAX;
     }
 
+    sf_domain_table table;
+    u32 table_size = 16;
+    while (table_size < ir->node_count * 2) table_size *= 2;
+    table.slots = SF_ARENA_PUSH(ctx->arena, u32, table_size);
+    table.mask = table_size - 1;
+    for (u32 i = 0; i < table_size; ++i) table.slots[i] = UINT32_MAX;
+    u32* stack = SF_ARENA_PUSH(ctx->arena, u32, ir->node_count);
+
     // 2. Find all potential domain representatives (outputs or nodes with unique shapes)
-    // and propagate their domain backwards.
+    // and propagate their domain backwards. The first node of each shape becomes its representative.
     for (size_t i = 0; i < ir->node_count; ++i) {
-        if (ir->nodes[i].type == SF_NODE_OUTPUT || ir->nodes[i].domain_node_idx == UINT32_MAX) {
-            u32 rep_idx = (u32)i;
-            // Try to find an existing representative with the same shape
-            for (size_t j = 0; j < ir->node_count; ++j) {
-                if (ir->nodes[j].domain_node_idx == (u32)j && 
-                    shapes_equal(&ir->nodes[j].out_info, &ir->nodes[i].out_info)) 
-                {
-                    rep_idx = (u32)j;
-                    break;
-                }
-            }
-            mark_domain(ir, (u32)i, rep_idx);
-        }
+        if (ir->nodes[i].domain_node_idx != UINT32_MAX) continue; // Marked outputs would be a no-op
+        u32 rep_idx = domain_table_find_or_add(&table, ir, (u32)i);
+        mark_domain(ir, (u32)i, rep_idx, stack);
     }
 
     return true;
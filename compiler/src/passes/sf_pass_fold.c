@@ -0,0 +1,193 @@
+#include "../sf_passes.h"
+#include "../sf_graph_utils.h"
+#include "../sf_compiler_internal.h"
+#include <sionflow/base/sf_log.h>
+#include <sionflow/base/sf_shape.h>
+#include <math.h>
+#include <string.h>
+
+/**
+ * Constant Folding Pass
+ * Evaluates nodes whose result is known at compile time and turns them into CONST nodes:
+ * - Arithmetic (ADD, MUL, DIV, FMA, REDUCE_SUM) over CONST inputs, with broadcasting.
+ * - Shape queries (SIZE) over any input with a static shape.
+ * Runs in topological order after shape analysis, so whole constant chains collapse in one
+ * sweep. Results larger than options->fold_max_bytes stay runtime instructions.
+ */
+
+static bool is_static(const sf_type_info* info) {
+    for (u8 d = 0; d < info->ndim; ++d) if (info->shape[d] <= 0) return false;
+    return true;
+}
+
+static f64 load_elem(const void* data, sf_dtype dtype, size_t i) {
+    switch (dtype) {
+        case SF_DTYPE_F32: return (f64)((const f32*)data)[i];
+        case SF_DTYPE_I32: return (f64)((const i32*)data)[i];
+        case SF_DTYPE_U8:  return (f64)((const u8*)data)[i];
+        default: return 0.0;
+    }
+}
+
+static void store_elem(void* data, sf_dtype dtype, size_t i, f64 v) {
+    switch (dtype) {
+        case SF_DTYPE_F32: ((f32*)data)[i] = (f32)v; break;
+        case SF_DTYPE_I32: ((i32*)data)[i] = (i32)v; break;
+        case SF_DTYPE_U8:  ((u8*)data)[i] = (u8)v; break;
+        default: break;
+    }
+}
+
+// Element of 'src' that broadcasts onto flat index 'i' of 'dst'
+static size_t broadcast_index(const sf_type_info* dst, const i32* src_strides, size_t i) {
+    size_t offset = 0;
+    for (int d = dst->ndim - 1; d >= 0; --d) {
+        size_t extent = (size_t)dst->shape[d];
+        offset += (i % extent) * (size_t)src_strides[d];
+        i /= extent;
+    }
+    return offset;
+}
+
+// Reference semantics of one element: F32 results are rounded to f32 after every op like the
+// VM does, integer results wrap around.
+static f64 eval_binary(sf_node_type type, sf_dtype dtype, f64 a, f64 b) {
+    if (dtype == SF_DTYPE_F32) {
+        f64 r = 0.0;
+        switch (type) {
+            case SF_NODE_ADD: r = a + b; break;
+            case SF_NODE_MUL: r = a * b; break;
+            case SF_NODE_DIV: r = a / b; break;
+            default: break;
+        }
+        return (f64)(f32)r;
+    }
+    i64 r = (type == SF_NODE_MUL) ? (i64)a * (i64)b : (i64)a + (i64)b;
+    return dtype == SF_DTYPE_U8 ? (f64)(u8)r : (f64)(i32)(u32)r;
+}
+
+typedef struct {
+    const sf_ir_node* node;
+    i32 strides[SF_MAX_DIMS]; // Element strides broadcast onto the result
+} sf_fold_operand;
+
+static bool fold_node(sf_graph_ir* ir, u32 node_idx, sf_arena* arena, u64 max_bytes) {
+    sf_ir_node* node = &ir->nodes[node_idx];
+    const sf_op_metadata* meta = &SF_OP_METADATA[node->type];
+    sf_type_info* out = &node->out_info;
+    if (node->resource_flags || !is_static(out)) return false;
+
+    sf_dtype dtype = out->dtype;
+    if (dtype != SF_DTYPE_F32 && dtype != SF_DTYPE_I32 && dtype != SF_DTYPE_U8) return false;
+    size_t count = sf_shape_calc_count(out->shape, out->ndim);
+    u64 bytes = (u64)count * sf_dtype_size(dtype);
+    if (bytes == 0 || bytes > max_bytes) return false;
+
+    sf_fold_operand ops[4] = {0};
+    u32 op_count = 0;
+    for (u32 k = 0; k < 4; ++k) {
+        if (!meta->ports[k]) continue;
+        sf_ir_node* src = find_input_source(ir, node_idx, k);
+        if (!src) return false;
+        ops[op_count].node = src;
+        sf_shape_get_broadcast_strides(&src->out_info, out, ops[op_count].strides);
+        op_count++;
+    }
+
+    // Every value operand must be a materialized constant matching its analyzed shape
+    if (node->type != SF_NODE_SIZE) {
+        for (u32 k = 0; k < op_count; ++k) {
+            const sf_ir_node* src = ops[k].node;
+            if (src->type != SF_NODE_CONST || !src->const_data || !is_static(&src->out_info)) return false;
+            if (sf_shape_calc_count(src->const_info.shape, src->const_info.ndim) != sf_shape_calc_count(src->out_info.shape, src->out_info.ndim)) return false;
+        }
+    }
+
+    void* data = NULL;
+    switch (node->type) {
+        case SF_NODE_SIZE: {
+            if (op_count != 1 || !is_static(&ops[0].node->out_info)) return false;
+            data = SF_ARENA_PUSH(arena, u8, bytes);
+            f64 size = (f64)sf_shape_calc_count(ops[0].node->out_info.shape, ops[0].node->out_info.ndim);
+            for (size_t i = 0; i < count; ++i) store_elem(data, dtype, i, size);
+            break;
+        }
+        case SF_NODE_ADD:
+        case SF_NODE_MUL:
+        case SF_NODE_DIV: {
+            if (op_count != 2) return false;
+            // Integer division semantics (rounding, division by zero) are left to the VM
+            if (node->type == SF_NODE_DIV && dtype != SF_DTYPE_F32) return false;
+            data = SF_ARENA_PUSH(arena, u8, bytes);
+            for (size_t i = 0; i < count; ++i) {
+                f64 a = load_elem(ops[0].node->const_data, ops[0].node->const_info.dtype, broadcast_index(out, ops[0].strides, i));
+                f64 b = load_elem(ops[1].node->const_data, ops[1].node->const_info.dtype, broadcast_index(out, ops[1].strides, i));
+                store_elem(data, dtype, i, eval_binary(node->type, dtype, a, b));
+            }
+            break;
+        }
+        case SF_NODE_FMA: {
+            if (op_count != 3 || dtype != SF_DTYPE_F32) return false;
+            data = SF_ARENA_PUSH(arena, u8, bytes);
+            for (size_t i = 0; i < count; ++i) {
+                f64 a = load_elem(ops[0].node->const_data, ops[0].node->const_info.dtype, broadcast_index(out, ops[0].strides, i));
+                f64 b = load_elem(ops[1].node->const_data, ops[1].node->const_info.dtype, broadcast_index(out, ops[1].strides, i));
+                f64 c = load_elem(ops[2].node->const_data, ops[2].node->const_info.dtype, broadcast_index(out, ops[2].strides, i));
+                store_elem(data, dtype, i, (f64)fmaf((f32)a, (f32)b, (f32)c)); // Single rounding like the fused VM op
+            }
+            break;
+        }
+        case SF_NODE_REDUCE_SUM:
+        case SF_NODE_REDUCE_SUM_STABLE: {
+            // Full reductions only; axis semantics are the VM's business
+            if (op_count != 1 || count != 1) return false;
+            const sf_ir_node* src = ops[0].node;
+            size_t n = sf_shape_calc_count(src->out_info.shape, src->out_info.ndim);
+            // The stable F32 kernel is matched by f64 accumulation; everything else adds step by step
+            // like the VM (f32 rounding, integer wrap-around)
+            bool wide = node->type == SF_NODE_REDUCE_SUM_STABLE && dtype == SF_DTYPE_F32;
+            f64 sum = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                f64 v = load_elem(src->const_data, src->const_info.dtype, i);
+                sum = wide ? sum + v : eval_binary(SF_NODE_ADD, dtype, sum, v);
+            }
+            data = SF_ARENA_PUSH(arena, u8, bytes);
+            store_elem(data, dtype, 0, sum);
+            break;
+        }
+        default:
+            return false;
+    }
+
+    // Becomes a CONST in place: users keep their links, the inputs are released
+    for (u32 k = 0; k < 4; ++k) sf_builder_disconnect(ir, (sf_port){ node_idx, k });
+    node->type = SF_NODE_CONST;
+    node->const_info = *out;
+    node->const_data = data;
+    return true;
+}
+
+bool sf_pass_fold(sf_pass_ctx* ctx, sf_compiler_diag* diag) {
+    (void)diag;
+    sf_graph_ir* ir = ctx->ir;
+    sf_ir_node** sorted = ctx->sorted_nodes;
+    if (!sorted) return true;
+
+    u64 max_bytes = ctx->options ? ctx->options->fold_max_bytes : SF_DEFAULT_FOLD_MAX_BYTES;
+    if (max_bytes == 0) return true;
+    u32 folded = 0;
+    for (size_t i = 0; i < ctx->sorted_count; ++i) {
+        sf_ir_node* node = sorted[i];
+        switch (node->type) {
+            case SF_NODE_ADD: case SF_NODE_MUL: case SF_NODE_DIV: case SF_NODE_FMA:
+            case SF_NODE_SIZE: case SF_NODE_REDUCE_SUM: case SF_NODE_REDUCE_SUM_STABLE:
+                if (fold_node(ir, (u32)(node - ir->nodes), ctx->arena, max_bytes)) folded++;
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (folded > 0) SF_LOG_DEBUG("Constant Folding: %u nodes evaluated at compile time", folded);
+    return true;
+}
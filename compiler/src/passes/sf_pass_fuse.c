@@ -1,33 +1,84 @@
 #include "../sf_passes.h"
 #include "../sf_graph_utils.h"
+#include <string.h>
 
 /**
  * Op Fusion Pass
  * Fuses multiple operations into a single specialized opcode (e.g., MUL+ADD -> FMA).
+ *
+ * Driven by a worklist: a rewrite only re-queues the fused node, its consumers and its
+ * producers, so each node is revisited a bounded number of times instead of restarting
+ * the whole scan.
  */
+
+typedef struct {
+    u32* items;
+    u32 head;
+    u32 tail;
+    u32 capacity;
+    u8* queued;         // Indexed by node, grows with the graph
+    u32 queued_capacity;
+    sf_arena* arena;
+} sf_fuse_worklist;
+
+static void worklist_push(sf_fuse_worklist* wl, u32 node_idx) {
+    if (node_idx >= wl->queued_capacity) {
+        u32 cap = wl->queued_capacity * 2;
+        while (cap <= node_idx) cap *= 2;
+        u8* queued = SF_ARENA_PUSH(wl->arena, u8, cap);
+        memcpy(queued, wl->queued, wl->queued_capacity);
+        memset(queued + wl->queued_capacity, 0, cap - wl->queued_capacity);
+        wl->queued = queued; wl->queued_capacity = cap;
+    }
+    if (wl->queued[node_idx]) return;
+    if (wl->tail == wl->capacity) {
+        // Compact consumed slots first, grow only if the queue is genuinely full
+        u32 live = wl->tail - wl->head;
+        u32 cap = live * 2 >= wl->capacity ? wl->capacity * 2 : wl->capacity;
+        u32* items = cap == wl->capacity ? wl->items : SF_ARENA_PUSH(wl->arena, u32, cap);
+        memmove(items, wl->items + wl->head, live * sizeof(u32));
+        wl->items = items; wl->capacity = cap; wl->head = 0; wl->tail = live;
+    }
+    wl->items[wl->tail++] = node_idx;
+    wl->queued[node_idx] = 1;
+}
+
+static void queue_neighbours(sf_fuse_worklist* wl, const sf_graph_ir* ir, u32 node_idx) {
+    const sf_ir_node* node = &ir->nodes[node_idx];
+    worklist_push(wl, node_idx);
+    for (const sf_ir_user* u = node->users; u; u = u->next) worklist_push(wl, u->node_idx);
+    for (u32 p = 0; p < 4; ++p) {
+        sf_port src = sf_builder_get_source((sf_graph_ir*)ir, (sf_port){ node_idx, p });
+        if (!SF_PORT_IS_NULL(src)) worklist_push(wl, src.node_idx);
+    }
+}
+
 bool sf_pass_fuse(sf_pass_ctx* ctx, sf_compiler_diag* diag) {
     sf_graph_ir* ir = ctx->ir;
     sf_arena* arena = ctx->arena;
-    bool changed = true;
-
-    // We keep fusing as long as changes are made
-    while (changed) {
-        changed = false;
-        u32 initial_count = (u32)ir->node_count;
-
-        for (u32 i = 0; i < initial_count; ++i) {
-            sf_ir_node* node = &ir->nodes[i];
-            if (node->type == SF_NODE_UNKNOWN) continue;
-
-            for (size_t r = 0; r < SF_FUSION_RULE_COUNT; ++r) {
-                if (sf_ir_node_try_fuse(ir, i, &SF_FUSION_RULES[r], arena)) {
-                    changed = true;
-                    break;
-                }
-            }
-            if (changed) break;
-        }
+    if (SF_FUSION_PATTERN_COUNT == 0 || ir->node_count == 0) return true;
+
+    // Seed with every live node in index order, which matches the old scan order.
+    // Rule selection itself is the generated opcode switch in sf_fusion_match_node.
+    sf_fuse_worklist wl = { .arena = arena };
+    wl.capacity = (u32)ir->node_count * 2;
+    wl.items = SF_ARENA_PUSH(arena, u32, wl.capacity);
+    wl.queued_capacity = (u32)ir->node_count * 2;
+    wl.queued = SF_ARENA_PUSH(arena, u8, wl.queued_capacity);
+    memset(wl.queued, 0, wl.queued_capacity);
+    for (u32 i = 0; i < ir->node_count; ++i) {
+        if (ir->nodes[i].type != SF_NODE_UNKNOWN) worklist_push(&wl, i);
+    }
+
+    while (wl.head < wl.tail) {
+        u32 i = wl.items[wl.head++];
+        wl.queued[i] = 0;
+        if (ir->nodes[i].type == SF_NODE_UNKNOWN) continue;
+
+        u32 fused = sf_ir_node_try_fuse(ir, i, arena);
+        if (fused != UINT32_MAX) queue_neighbours(&wl, ir, fused);
     }
 
+    (void)diag;
     return true;
 }
@@ -2,6 +2,7 @@
 #include "../sf_graph_utils.h"
 #include "../sf_compiler_internal.h"
 #include <sionflow/base/sf_log.h>
+#include <stdio.h>
 #include <string.h>
 
 /**
@@ -13,39 +14,169 @@
 // Function defined in sf_json_parser.c
 bool sf_compile_load_json_ir(const char* json_path, sf_graph_ir* out_ir, sf_arena* arena, sf_compiler_diag* diag, const char* base_path);
 
+// --- Subgraph Cache ---
+// Each subgraph file is read and lowered once per compilation; every further CALL
+// of the same file only grafts the cached IR (grafting never mutates the source).
+
+typedef struct {
+    const char* path; // Canonical path
+    u64 hash;
+    sf_graph_ir ir;
+} sf_subgraph_entry;
+
+typedef struct {
+    sf_subgraph_entry* entries;
+    u32 count;
+    u32 cap;
+} sf_subgraph_cache;
+
+// Lexically normalizes a path: unifies separators and folds "." and ".." segments.
+static char* canonical_path(const char* path, sf_arena* arena) {
+    size_t len = strlen(path);
+    char* out = SF_ARENA_PUSH(arena, char, len + 1);
+    size_t* seg_starts = SF_ARENA_PUSH(arena, size_t, len + 1);
+    size_t o = 0, depth = 0;
+    bool absolute = (path[0] == '/' || path[0] == '\\');
+    if (absolute) out[o++] = '/';
+
+    const char* p = path;
+    while (*p) {
+        while (*p == '/' || *p == '\\') p++;
+        const char* seg = p;
+        while (*p && *p != '/' && *p != '\\') p++;
+        size_t seg_len = (size_t)(p - seg);
+        if (seg_len == 0 || (seg_len == 1 && seg[0] == '.')) continue;
+        if (seg_len == 2 && seg[0] == '.' && seg[1] == '.' && depth > 0) {
+            o = seg_starts[--depth];
+            continue;
+        }
+        size_t start = o;
+        if (o > 0 && out[o - 1] != '/') out[o++] = '/';
+        // Leading ".." segments of relative paths cannot be folded
+        if (!(seg_len == 2 && seg[0] == '.' && seg[1] == '.')) seg_starts[depth++] = start;
+        memcpy(out + o, seg, seg_len);
+        o += seg_len;
+    }
+    out[o] = '\0';
+    return out;
+}
+
+static const sf_graph_ir* subgraph_cache_get(sf_subgraph_cache* cache, const char* sub_path, const char* canonical, sf_pass_ctx* ctx, sf_compiler_diag* diag) {
+    sf_arena* arena = ctx->arena;
+    u64 hash = sf_hash64_str(canonical, SF_HASH64_SEED);
+
+    for (u32 i = 0; i < cache->count; ++i) {
+        if (cache->entries[i].hash == hash && strcmp(cache->entries[i].path, canonical) == 0) return &cache->entries[i].ir;
+    }
+
+    if (cache->count == cache->cap) {
+        u32 new_cap = cache->cap ? cache->cap * 2 : 16;
+        sf_subgraph_entry* entries = SF_ARENA_PUSH(arena, sf_subgraph_entry, new_cap);
+        if (cache->count) memcpy(entries, cache->entries, sizeof(sf_subgraph_entry) * cache->count);
+        cache->entries = entries;
+        cache->cap = new_cap;
+    }
+
+    sf_subgraph_entry* e = &cache->entries[cache->count];
+    memset(e, 0, sizeof(*e));
+    if (!sf_compile_load_json_ir(sub_path, &e->ir, arena, diag, ctx->base_path)) return NULL;
+    e->path = canonical;
+    e->hash = hash;
+    cache->count++;
+    return &e->ir;
+}
+
+// --- Worklist ---
+// Every CALL node is visited exactly once. Calls exposed by a grafted subgraph are
+// appended with a link to the site that introduced them, which gives us the import
+// chain for cycle detection without re-scanning the graph.
+
+#define SF_INLINE_MAX_DEPTH 64
+
+typedef struct {
+    u32 node_idx;
+    u32 parent;     // Site that grafted this CALL (UINT32_MAX for calls of the root graph)
+    u32 depth;
+    const char* path; // Canonical subgraph path
+} sf_inline_site;
+
+typedef struct {
+    sf_inline_site* sites;
+    u32 count;
+    u32 cap;
+} sf_inline_worklist;
+
+static void worklist_push(sf_inline_worklist* wl, sf_graph_ir* ir, u32 node_idx, u32 parent, u32 depth, sf_arena* arena) {
+    if (wl->count == wl->cap) {
+        u32 new_cap = wl->cap ? wl->cap * 2 : 64;
+        sf_inline_site* sites = SF_ARENA_PUSH(arena, sf_inline_site, new_cap);
+        if (wl->count) memcpy(sites, wl->sites, sizeof(sf_inline_site) * wl->count);
+        wl->sites = sites;
+        wl->cap = new_cap;
+    }
+    wl->sites[wl->count++] = (sf_inline_site){ node_idx, parent, depth, canonical_path(ir->nodes[node_idx].sub_graph_path, arena) };
+}
+
+static void collect_calls(sf_inline_worklist* wl, sf_graph_ir* ir, u32 begin, u32 end, u32 parent, u32 depth, sf_arena* arena) {
+    for (u32 i = begin; i < end; ++i) {
+        if (ir->nodes[i].type == SF_NODE_CALL && ir->nodes[i].sub_graph_path) worklist_push(wl, ir, i, parent, depth, arena);
+    }
+}
+
+static bool report_cycle(const sf_inline_worklist* wl, u32 site_idx, sf_ir_node* node, sf_compiler_diag* diag) {
+    const char* path = wl->sites[site_idx].path;
+    for (u32 p = wl->sites[site_idx].parent; p != UINT32_MAX; p = wl->sites[p].parent) {
+        if (strcmp(wl->sites[p].path, path) != 0) continue;
+        char chain[200] = {0};
+        size_t len = 0;
+        for (u32 c = site_idx; c != wl->sites[p].parent && len < sizeof(chain) - 1; c = wl->sites[c].parent) {
+            len += (size_t)snprintf(chain + len, sizeof(chain) - len, "%s%s", len ? " <- " : "", wl->sites[c].path);
+        }
+        SF_REPORT_NODE(diag, node, "Inlining Error: Recursive import (%s)", chain);
+        return true;
+    }
+    return false;
+}
+
 bool sf_pass_inline_wrapper(sf_pass_ctx* ctx, sf_compiler_diag* diag) {
     sf_graph_ir* ir = ctx->ir;
     sf_arena* arena = ctx->arena;
-    bool changed = true;
-
-    // We keep inlining as long as we find CALL nodes
-    while (changed) {
-        changed = false;
-        u32 initial_count = (u32)ir->node_count;
-
-        for (u32 i = 0; i < initial_count; ++i) {
-            sf_ir_node* node = &ir->nodes[i];
-            if (node->type != SF_NODE_CALL || !node->sub_graph_path) continue;
-
-            SF_LOG_DEBUG("Inlining subgraph: %s", node->sub_graph_path);
-
-            // 1. Load Subgraph IR
-            sf_graph_ir subgraph = {0};
-            if (!sf_compile_load_json_ir(node->sub_graph_path, &subgraph, arena, diag, ctx->base_path)) {
-                SF_LOG_ERROR("Failed to load subgraph for inlining: %s", node->sub_graph_path);
-                return false;
-            }
-
-            // 2. Perform Professional Inline
-            if (!sf_ir_node_inline(ir, i, &subgraph, node->id, arena)) {
-                SF_REPORT_NODE(diag, node, "Inlining Error: Graph capacity exceeded");
-                return false;
-            }
-
-            changed = true;
-            break; // Restart loop because node indices and counts have changed
+    sf_subgraph_cache cache = {0};
+    sf_inline_worklist wl = {0};
+
+    collect_calls(&wl, ir, 0, (u32)ir->node_count, UINT32_MAX, 0, arena);
+
+    for (u32 s = 0; s < wl.count; ++s) {
+        sf_inline_site site = wl.sites[s];
+        sf_ir_node* node = &ir->nodes[site.node_idx];
+
+        if (report_cycle(&wl, s, node, diag)) return false;
+        if (site.depth >= SF_INLINE_MAX_DEPTH) {
+            SF_REPORT_NODE(diag, node, "Inlining Error: Subgraph nesting deeper than %d (%s)", SF_INLINE_MAX_DEPTH, site.path);
+            return false;
+        }
+
+        SF_LOG_DEBUG("Inlining subgraph: %s", node->sub_graph_path);
+
+        // 1. Load Subgraph IR (once per file)
+        const sf_graph_ir* subgraph = subgraph_cache_get(&cache, node->sub_graph_path, site.path, ctx, diag);
+        if (!subgraph) {
+            SF_LOG_ERROR("Failed to load subgraph for inlining: %s", node->sub_graph_path);
+            return false;
+        }
+
+        // 2. Perform Professional Inline (grafted nodes are appended at the end)
+        u32 first_new = (u32)ir->node_count;
+        if (!sf_ir_graph_reserve(ir, arena, subgraph->node_count) ||
+            !sf_ir_node_inline(ir, site.node_idx, subgraph, ir->nodes[site.node_idx].id, arena)) {
+            SF_REPORT_NODE(diag, &ir->nodes[site.node_idx], "Inlining Error: Graph capacity exceeded");
+            return false;
         }
+
+        // 3. Queue the calls this subgraph brought in
+        collect_calls(&wl, ir, first_new, (u32)ir->node_count, s, site.depth + 1, arena);
     }
 
+    if (cache.count > 0) SF_LOG_DEBUG("Inlining: %u call sites, %u distinct subgraphs", wl.count, cache.count);
     return true;
-}
\ No newline at end of file
+}
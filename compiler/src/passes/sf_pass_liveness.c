@@ -25,6 +25,147 @@ static u32 trace_register_source(sf_graph_ir* ir, u32 node_idx, int depth) {
     return node_idx;
 }
 
+// --- Linear Scan ---
+// Live intervals are measured in positions of ctx->sorted_nodes. A register is reused only
+// once every consumer of its previous value has executed, and only by a value of identical
+// dtype and static shape, so the tensor info recorded per register stays valid.
+
+static bool is_reusable_info(const sf_type_info* info) {
+    for (u8 d = 0; d < info->ndim; ++d) if (info->shape[d] <= 0) return false; // Dynamic dims resolve at runtime
+    return true;
+}
+
+static bool same_info(const sf_type_info* a, const sf_type_info* b) {
+    if (a->dtype != b->dtype || a->ndim != b->ndim) return false;
+    for (u8 d = 0; d < a->ndim; ++d) if (a->shape[d] != b->shape[d]) return false;
+    return true;
+}
+
+// In-place: an INPLACE op may take over the register of an input whose last use is that
+// very instruction. Identical type and shape means every element is read before it is
+// overwritten at the same index.
+static bool try_inplace(sf_graph_ir* ir, const sf_ir_node* node, u32 p, u16 v, const u32* end, const u32* def_node, const u8* pinned, u16* phys, u8* donated) {
+    if (!(SF_COMPILER_NODE_TRAITS[node->type] & SF_NODE_TRAIT_INPLACE)) return false;
+    for (u32 k = 0; k < 4; ++k) {
+        u32 src = node->inputs[k].src_node_idx;
+        if (src == UINT32_MAX) continue;
+        u16 u = ir->nodes[src].out_reg_idx;
+        if (u == v || pinned[u] || donated[u] || end[u] != p || phys[u] == 0xFFFF) continue;
+        if (!same_info(&ir->nodes[def_node[u]].out_info, &ir->nodes[def_node[v]].out_info)) continue;
+        phys[v] = phys[u];
+        donated[u] = 1;
+        return true;
+    }
+    return false;
+}
+
+static bool allocate_registers(sf_pass_ctx* ctx, u16 vreg_count, u16* out_count, u32* inplace_count) {
+    sf_graph_ir* ir = ctx->ir;
+    sf_arena* arena = ctx->arena;
+    sf_ir_node** sorted = ctx->sorted_nodes;
+    u32 count = (u32)ctx->sorted_count;
+    if (vreg_count == 0) return true;
+
+    u32* start = SF_ARENA_PUSH(arena, u32, vreg_count);
+    u32* end = SF_ARENA_PUSH(arena, u32, vreg_count);
+    u32* def_node = SF_ARENA_PUSH(arena, u32, vreg_count);
+    u8* pinned = SF_ARENA_PUSH(arena, u8, vreg_count);
+    u16* phys = SF_ARENA_PUSH(arena, u16, vreg_count);
+    u8* donated = SF_ARENA_PUSH(arena, u8, vreg_count);
+    if (!start || !end || !def_node || !pinned || !phys || !donated) return false;
+    for (u16 v = 0; v < vreg_count; ++v) {
+        start[v] = UINT32_MAX; end[v] = 0; def_node[v] = UINT32_MAX; pinned[v] = 0; phys[v] = 0xFFFF; donated[v] = 0;
+    }
+    // Register 0 doubles as "no input" in task bindings, so it keeps its single owner
+    pinned[0] = 1;
+
+    // 1. Intervals. Bridges share their source register, so their consumers extend it too.
+    for (u32 p = 0; p < count; ++p) {
+        sf_ir_node* node = sorted[p];
+        if (node->type == SF_NODE_UNKNOWN) continue;
+        u32 node_idx = (u32)(node - ir->nodes);
+        u16 v = node->out_reg_idx;
+        if (start[v] == UINT32_MAX) start[v] = p;
+        if (end[v] < p) end[v] = p;
+        if (def_node[v] == UINT32_MAX) def_node[v] = node_idx;
+        // A RESHAPE/SLICE view describes the register differently than its producer
+        else if (!same_info(&node->out_info, &ir->nodes[def_node[v]].out_info)) pinned[v] = 1;
+
+        if (node->type == SF_NODE_CONST || node->type == SF_NODE_INPUT || node->type == SF_NODE_OUTPUT || node->resource_flags) pinned[v] = 1;
+
+        for (u32 k = 0; k < 4; ++k) {
+            u32 src = node->inputs[k].src_node_idx;
+            if (src == UINT32_MAX) continue;
+            u16 sv = ir->nodes[src].out_reg_idx;
+            if (end[sv] < p) end[sv] = p;
+        }
+        // Tasks read their domain register for the grid
+        if (node->domain_node_idx != UINT32_MAX) {
+            u16 dv = ir->nodes[node->domain_node_idx].out_reg_idx;
+            if (end[dv] < p) end[dv] = p;
+        }
+    }
+    for (u16 v = 0; v < vreg_count; ++v) {
+        if (start[v] == UINT32_MAX || !is_reusable_info(&ir->nodes[def_node[v]].out_info)) pinned[v] = 1;
+    }
+
+    // 2. Bucket intervals by their last use so expiry is O(1) per position
+    u32* expire_head = SF_ARENA_PUSH(arena, u32, count + 1);
+    u32* expire_next = SF_ARENA_PUSH(arena, u32, vreg_count);
+    u16* free_regs = SF_ARENA_PUSH(arena, u16, vreg_count);
+    u32* free_info = SF_ARENA_PUSH(arena, u32, vreg_count); // Defining node of the freed value
+    if (!expire_head || !expire_next || !free_regs || !free_info) return false;
+    for (u32 p = 0; p <= count; ++p) expire_head[p] = UINT32_MAX;
+    for (u16 v = 0; v < vreg_count; ++v) {
+        if (pinned[v]) continue;
+        expire_next[v] = expire_head[end[v]];
+        expire_head[end[v]] = v;
+    }
+
+    // 3. Scan. Values defined at 'p' are allocated before intervals ending at 'p' expire,
+    //    so an instruction only writes a register one of its own inputs occupies via try_inplace.
+    u32 free_count = 0;
+    u16 next_phys = 1;
+    phys[0] = 0;
+    for (u32 p = 0; p < count; ++p) {
+        if (p > 0) {
+            for (u32 v = expire_head[p - 1]; v != UINT32_MAX; v = expire_next[v]) {
+                if (donated[v]) continue; // Its register now belongs to an in-place result
+                free_regs[free_count] = phys[v];
+                free_info[free_count++] = def_node[v];
+            }
+        }
+
+        u16 v = sorted[p]->out_reg_idx;
+        if (sorted[p]->type == SF_NODE_UNKNOWN || start[v] != p || phys[v] != 0xFFFF) continue;
+
+        if (!pinned[v] && try_inplace(ir, sorted[p], p, v, end, def_node, pinned, phys, donated)) {
+            (*inplace_count)++;
+            continue;
+        }
+        if (!pinned[v]) {
+            const sf_type_info* info = &ir->nodes[def_node[v]].out_info;
+            for (u32 f = free_count; f-- > 0;) {
+                if (!same_info(&ir->nodes[free_info[f]].out_info, info)) continue;
+                phys[v] = free_regs[f];
+                free_regs[f] = free_regs[--free_count];
+                free_info[f] = free_info[free_count];
+                break;
+            }
+        }
+        if (phys[v] == 0xFFFF) phys[v] = next_phys++;
+    }
+    for (u16 v = 0; v < vreg_count; ++v) if (phys[v] == 0xFFFF) phys[v] = next_phys++;
+
+    // 4. Rewrite
+    for (size_t i = 0; i < ir->node_count; ++i) {
+        sf_ir_node* node = &ir->nodes[i];
+        if (node->out_reg_idx < vreg_count) node->out_reg_idx = phys[node->out_reg_idx];
+    }
+    *out_count = next_phys;
+    return true;
+}
+
 bool sf_pass_liveness(sf_pass_ctx* ctx, sf_compiler_diag* diag) {
     sf_graph_ir* ir = ctx->ir;
     sf_ir_node** sorted = ctx->sorted_nodes;
@@ -64,12 +205,15 @@ bool sf_pass_liveness(sf_pass_ctx* ctx, sf_compiler_diag* diag) {
         }
     }
 
-    // 3. (Optional) Register reuse algorithm for temporary buffers
-    // For now, we keep it simple: every compute node has its own register 
-    // unless it was aliased. Optimization of 'next_reg' can be added back later
-    // once we verify stability.
+    // 3. Register reuse (Linear Scan)
+    u16 phys_count = next_reg;
+    u32 inplace_count = 0;
+    if (!allocate_registers(ctx, next_reg, &phys_count, &inplace_count)) {
+        SF_REPORT(diag, NULL, "Liveness Pass: Register allocation failed");
+        return false;
+    }
 
-    SF_LOG_INFO("Liveness: Allocated %u registers for %zu compute nodes", next_reg, count);
+    SF_LOG_INFO("Liveness: Allocated %u registers (%u before reuse, %u in-place) for %zu nodes", phys_count, next_reg, inplace_count, count);
 
     return true;
-}
\ No newline at end of file
+}
@@ -69,7 +69,7 @@ static bool handle_axis(sf_ir_node* dst, const sf_json_value* val, const char* b
 }
 
 static bool handle_value(sf_ir_node* dst, const sf_json_value* val, const char* bp, sf_arena* arena, sf_compiler_diag* d) {
-    (void)bp; (void)d;
+    if (val->type == SF_JSON_VAL_OBJECT) return sf_ir_load_const_payload(dst, val, bp, arena, d);
     if (dst->const_info.ndim == 0 && val->type == SF_JSON_VAL_ARRAY) {
         dst->const_info.ndim = 1; dst->const_info.shape[0] = (int32_t)val->as.array.count;
         sf_shape_calc_strides(&dst->const_info); dst->out_info = dst->const_info;
@@ -91,26 +91,29 @@ static const sf_attr_def ATTR_DEFS[] = {
 static bool parse_node_attributes(sf_ir_node* dst, const sf_json_value* data, const char* base_path, sf_arena* arena, sf_compiler_diag* diag) {
     if (!data || data->type != SF_JSON_VAL_OBJECT) return true;
     for (size_t i = 0; i < data->as.object.count; ++i) {
-        const char* key = data->as.object.keys[i];
-        const sf_json_value* val = &data->as.object.values[i];
-        bool found = false;
-        for (size_t j = 0; j < sizeof(ATTR_DEFS)/sizeof(ATTR_DEFS[0]); ++j) {
-            if (strcmp(key, ATTR_DEFS[j].key) == 0) {
-                if (ATTR_DEFS[j].handler) if (!ATTR_DEFS[j].handler(dst, val, base_path, arena, diag)) return false;
-                found = true; break;
-            }
-        }
-        if (strcmp(key, "meta") == 0 && val->type == SF_JSON_VAL_OBJECT) { if (!parse_node_attributes(dst, val, base_path, arena, diag)) return false; found = true; }
-        if (!found && strcmp(key, "domain") != 0 && strcmp(key, "output") != 0 && strcmp(key, "name") != 0) {
-            sf_compiler_diag_report(diag, dst->loc, "Warning: Unknown attribute '%s' for node '%s'", key, dst->id);
+        if (!sf_lower_node_attribute(dst, data->as.object.keys[i], &data->as.object.values[i], base_path, arena, diag)) return false;
+    }
+    return true;
+}
+
+bool sf_lower_node_attribute(sf_ir_node* dst, const char* key, const sf_json_value* val, const char* base_path, sf_arena* arena, sf_compiler_diag* diag) {
+    bool found = false;
+    for (size_t j = 0; j < sizeof(ATTR_DEFS)/sizeof(ATTR_DEFS[0]); ++j) {
+        if (strcmp(key, ATTR_DEFS[j].key) == 0) {
+            if (ATTR_DEFS[j].handler) if (!ATTR_DEFS[j].handler(dst, val, base_path, arena, diag)) return false;
+            found = true; break;
         }
     }
+    if (strcmp(key, "meta") == 0 && val->type == SF_JSON_VAL_OBJECT) { if (!parse_node_attributes(dst, val, base_path, arena, diag)) return false; found = true; }
+    if (!found && strcmp(key, "domain") != 0 && strcmp(key, "output") != 0 && strcmp(key, "name") != 0) {
+        sf_compiler_diag_report(diag, dst->loc, "Warning: Unknown attribute '%s' for node '%s'", key, dst->id);
+    }
     return true;
 }
 
-static const char* find_import_for_type(sf_ast_graph* ast, const char* type_name, const char* base_path, sf_arena* arena) {
-    for (size_t i = 0; i < ast->import_count; ++i) {
-        const char* path = ast->imports[i];
+const char* sf_lower_find_import(const char* const* imports, size_t import_count, const char* type_name, const char* base_path, sf_arena* arena) {
+    for (size_t i = 0; i < import_count; ++i) {
+        const char* path = imports[i];
         char* name = sf_path_get_filename_no_ext(path, arena);
         if (strcmp(name, type_name) == 0) {
             if (sf_path_is_absolute(path)) return path;
@@ -139,7 +142,7 @@ bool sf_pass_lower(sf_ast_graph* ast, sf_graph_ir* out_ir, sf_arena* arena, cons
 
         if (type == SF_NODE_UNKNOWN) {
             // Strict Explicit Imports Only
-            sub_path = find_import_for_type(ast, src->type, base_path, arena);
+            sub_path = sf_lower_find_import((const char* const*)ast->imports, ast->import_count, src->type, base_path, arena);
             if (!sub_path) {
                 sf_compiler_diag_report(diag, (sf_source_loc){base_path, src->loc.line, src->loc.column}, 
                     "Unknown type '%s'. This type is not in ISA and not found in 'imports'.", src->type);
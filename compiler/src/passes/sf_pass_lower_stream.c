@@ -0,0 +1,877 @@
+#include "../sf_passes.h"
+#include "../sf_graph_utils.h"
+#include "../sf_compiler_internal.h"
+#include <sionflow/base/sf_utils.h>
+#include <sionflow/base/sf_log.h>
+#include <sionflow/base/sf_shape.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+ * Streaming Lowering Pass
+ * Tokenizes graph JSON once and emits IR nodes and links while parsing, so large graphs
+ * never exist as a document tree. Strings and flat numeric arrays (constant payloads) are
+ * scanned a word at a time (SWAR); 'value' arrays are converted straight into the
+ * constant buffer. Small attribute values go through the same handlers as sf_pass_lower.
+ * Only the expected shape of a graph is handled: anything else (unknown layouts, invalid
+ * JSON, duplicate IDs, ...) makes the pass bail out and the caller falls back to the AST
+ * path. Top-level members other than nodes/links/imports (app settings) are small and are
+ * handed to sf_ir_parse_window_settings as a document of their own.
+ */
+
+#define SF_STREAM_MAX_DEPTH 64
+#define SF_STREAM_SMALL_ARRAY 32 // Flat arrays up to this size are built on the stack
+
+#if (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) || defined(_MSC_VER)
+#define SF_STREAM_SWAR 1
+#else
+#define SF_STREAM_SWAR 0
+#endif
+
+// --- SWAR Scanning ---
+// Bytes equal to 'c' get their high bit set. Only the lowest flagged byte is exact (borrows
+// can flag bytes above it), which is all the scanners use.
+
+#define SF_SWAR_ONES  0x0101010101010101ULL
+#define SF_SWAR_HIGHS 0x8080808080808080ULL
+
+static inline u64 swar_match(u64 w, u8 c) {
+    u64 x = w ^ (SF_SWAR_ONES * c);
+    return (x - SF_SWAR_ONES) & ~x & SF_SWAR_HIGHS;
+}
+
+static inline u32 swar_first(u64 mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long idx;
+    _BitScanForward64(&idx, mask);
+    return (u32)idx >> 3;
+#elif defined(__GNUC__) || defined(__clang__)
+    return (u32)__builtin_ctzll(mask) >> 3;
+#else
+    u32 n = 0;
+    while (!(mask & 0x80)) { mask >>= 8; n++; }
+    return n;
+#endif
+}
+
+static inline u64 swar_load(const char* p) {
+    u64 w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+// First '"' or '\\' at or after p
+static const char* scan_string_special(const char* p, const char* end) {
+#if SF_STREAM_SWAR
+    while (end - p >= 8) {
+        u64 w = swar_load(p);
+        u64 m = swar_match(w, '"') | swar_match(w, '\\');
+        if (m) return p + swar_first(m);
+        p += 8;
+    }
+#endif
+    while (p < end && *p != '"' && *p != '\\') p++;
+    return p;
+}
+
+// First byte that is structural inside a flat number array: ',' ']' or a nested value
+static const char* scan_array_special(const char* p, const char* end) {
+#if SF_STREAM_SWAR
+    while (end - p >= 8) {
+        u64 w = swar_load(p);
+        u64 m = swar_match(w, ',') | swar_match(w, ']') | swar_match(w, '[') | swar_match(w, '{') | swar_match(w, '"');
+        if (m) return p + swar_first(m);
+        p += 8;
+    }
+#endif
+    while (p < end && *p != ',' && *p != ']' && *p != '[' && *p != '{' && *p != '"') p++;
+    return p;
+}
+
+// --- Stream State ---
+
+typedef struct {
+    char* data;
+    size_t cap;
+} sf_stream_buf;
+
+// Link to a node declared further down: src, src_port, dst, dst_port
+typedef struct {
+    const char* ids[4];
+} sf_stream_link;
+
+typedef struct {
+    u32 node_idx;
+    const char* ref; // Domain node ID or node type awaiting an import
+} sf_stream_pending;
+
+typedef struct {
+    sf_stream_pending* items;
+    u32 count;
+    u32 cap;
+} sf_stream_list;
+
+typedef struct {
+    const char* p;
+    const char* end;
+    const char* line_pos; // Lines are counted lazily up to here
+    u32 line;
+    const char* line_start;
+
+    sf_graph_ir* ir;
+    sf_arena* arena;
+    const char* base_path;
+    const char* loc_file;
+    sf_compiler_diag* diag;
+
+    // ID -> node index (open addressing; indices + 1, 0 is empty)
+    u32* id_slots;
+    u32 id_mask;
+
+    // Type name memo: sf_compiler_get_node_type is a linear search
+    const char* type_names[64];
+    sf_node_type type_values[64];
+
+    const char** imports;
+    u32 import_count;
+    bool imports_seen;
+
+    sf_stream_link* links;
+    u32 link_count;
+    u32 link_cap;
+    bool defer_links; // Once a link is deferred all later ones are too, keeping file order
+
+    sf_stream_list domains;
+    sf_stream_list calls;
+
+    const char** rest; // Spans of other top-level members: key start, value end
+    u32 rest_count;
+    u32 rest_cap;
+
+    sf_stream_buf key, id, type, str[4];
+} sf_json_stream;
+
+// Room for index 'count' in a heap array; returns the (possibly moved) array or NULL
+static void* grow(void* items, u32* cap, u32 count, size_t elem) {
+    if (count < *cap) return items;
+    u32 new_cap = *cap ? *cap * 2 : 64;
+    void* p = realloc(items, elem * new_cap);
+    if (p) *cap = new_cap;
+    return p;
+}
+
+static bool list_push(sf_stream_list* list, u32 node_idx, const char* ref) {
+    sf_stream_pending* items = grow(list->items, &list->cap, list->count, sizeof(sf_stream_pending));
+    if (!items) return false;
+    list->items = items;
+    list->items[list->count++] = (sf_stream_pending){ node_idx, ref };
+    return true;
+}
+
+static void skip_ws(sf_json_stream* s) {
+    const char* p = s->p;
+    while (p < s->end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) p++;
+    s->p = p;
+}
+
+static bool accept(sf_json_stream* s, char c) {
+    skip_ws(s);
+    if (s->p < s->end && *s->p == c) { s->p++; return true; }
+    return false;
+}
+
+static char peek(sf_json_stream* s) {
+    skip_ws(s);
+    return s->p < s->end ? *s->p : '\0';
+}
+
+static sf_source_loc current_loc(sf_json_stream* s) {
+    while (s->line_pos < s->p) {
+        const char* nl = memchr(s->line_pos, '\n', (size_t)(s->p - s->line_pos));
+        if (!nl) { s->line_pos = s->p; break; }
+        s->line++;
+        s->line_start = nl + 1;
+        s->line_pos = nl + 1;
+    }
+    return (sf_source_loc){ s->loc_file, s->line, (u32)(s->p - s->line_start) + 1 };
+}
+
+// --- Tokens ---
+
+static bool buf_reserve(sf_stream_buf* b, size_t size) {
+    if (size <= b->cap) return true;
+    size_t cap = b->cap ? b->cap : 64;
+    while (cap < size) cap *= 2;
+    char* data = realloc(b->data, cap);
+    if (!data) return false;
+    b->data = data;
+    b->cap = cap;
+    return true;
+}
+
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static bool read_hex4(const char* p, const char* end, u32* out) {
+    if (end - p < 4) return false;
+    u32 v = 0;
+    for (int i = 0; i < 4; ++i) {
+        int d = hex_digit(p[i]);
+        if (d < 0) return false;
+        v = (v << 4) | (u32)d;
+    }
+    *out = v;
+    return true;
+}
+
+static size_t put_utf8(char* dst, u32 cp) {
+    if (cp < 0x80) { dst[0] = (char)cp; return 1; }
+    if (cp < 0x800) { dst[0] = (char)(0xC0 | (cp >> 6)); dst[1] = (char)(0x80 | (cp & 0x3F)); return 2; }
+    if (cp < 0x10000) {
+        dst[0] = (char)(0xE0 | (cp >> 12)); dst[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        dst[2] = (char)(0x80 | (cp & 0x3F)); return 3;
+    }
+    dst[0] = (char)(0xF0 | (cp >> 18)); dst[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    dst[2] = (char)(0x80 | ((cp >> 6) & 0x3F)); dst[3] = (char)(0x80 | (cp & 0x3F)); return 4;
+}
+
+// Decodes the string at the cursor into 'out' (NUL-terminated). Never longer than the source.
+static bool read_string(sf_json_stream* s, sf_stream_buf* out) {
+    if (!accept(s, '"')) return false;
+    size_t o = 0;
+    for (;;) {
+        const char* special = scan_string_special(s->p, s->end);
+        if (special >= s->end) return false;
+        size_t run = (size_t)(special - s->p);
+        if (!buf_reserve(out, o + run + 5)) return false;
+        memcpy(out->data + o, s->p, run);
+        o += run;
+        s->p = special + 1;
+        if (*special == '"') break;
+
+        if (s->p >= s->end) return false;
+        char e = *s->p++;
+        switch (e) {
+            case '"': case '\\': case '/': out->data[o++] = e; break;
+            case 'b': out->data[o++] = '\b'; break;
+            case 'f': out->data[o++] = '\f'; break;
+            case 'n': out->data[o++] = '\n'; break;
+            case 'r': out->data[o++] = '\r'; break;
+            case 't': out->data[o++] = '\t'; break;
+            case 'u': {
+                u32 cp;
+                if (!read_hex4(s->p, s->end, &cp)) return false;
+                s->p += 4;
+                if (cp >= 0xD800 && cp <= 0xDBFF) {
+                    u32 lo;
+                    if (s->end - s->p < 6 || s->p[0] != '\\' || s->p[1] != 'u' || !read_hex4(s->p + 2, s->end, &lo)) return false;
+                    if (lo < 0xDC00 || lo > 0xDFFF) return false;
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                    s->p += 6;
+                }
+                if (cp == 0) return false; // Would truncate the C string
+                o += put_utf8(out->data + o, cp);
+                break;
+            }
+            default: return false;
+        }
+    }
+    if (!buf_reserve(out, o + 1)) return false;
+    out->data[o] = '\0';
+    return true;
+}
+
+static bool skip_string(sf_json_stream* s) {
+    if (!accept(s, '"')) return false;
+    for (;;) {
+        const char* special = scan_string_special(s->p, s->end);
+        if (special >= s->end) return false;
+        s->p = special + 1;
+        if (*special == '"') return true;
+        if (s->p >= s->end) return false;
+        s->p++; // Escaped character; \uXXXX digits contain no specials
+    }
+}
+
+static const f64 POW10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                             1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+// JSON number at the cursor. Values with at most 2^53 as mantissa and a small decimal
+// exponent are exact in one multiplication or division (correctly rounded, so identical to
+// strtod); everything else is handed to strtod.
+static bool read_number(sf_json_stream* s, f64* out) {
+    skip_ws(s);
+    const char* p = s->p;
+    const char* start = p;
+    bool neg = false;
+    if (p < s->end && *p == '-') { neg = true; p++; }
+    if (p >= s->end || *p < '0' || *p > '9') return false;
+
+    u64 mantissa = 0;
+    int digits = 0, exp10 = 0;
+    if (*p == '0') p++;
+    else {
+        while (p < s->end && *p >= '0' && *p <= '9') {
+            if (digits < 19) { mantissa = mantissa * 10 + (u64)(*p - '0'); digits += mantissa ? 1 : 0; }
+            else exp10++;
+            p++;
+        }
+    }
+    if (p < s->end && *p == '.') {
+        p++;
+        if (p >= s->end || *p < '0' || *p > '9') return false;
+        while (p < s->end && *p >= '0' && *p <= '9') {
+            if (digits < 19) { mantissa = mantissa * 10 + (u64)(*p - '0'); digits += mantissa ? 1 : 0; exp10--; }
+            p++;
+        }
+    }
+    bool simple = digits < 19;
+    if (p < s->end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool exp_neg = false;
+        if (p < s->end && (*p == '+' || *p == '-')) exp_neg = (*p++ == '-');
+        if (p >= s->end || *p < '0' || *p > '9') return false;
+        int e = 0;
+        while (p < s->end && *p >= '0' && *p <= '9') {
+            if (e < 10000) e = e * 10 + (*p - '0');
+            p++;
+        }
+        exp10 += exp_neg ? -e : e;
+    }
+    s->p = p;
+
+    if (simple && mantissa <= (1ULL << 53) && exp10 >= -22 && exp10 <= 22) {
+        f64 v = (f64)mantissa;
+        v = exp10 < 0 ? v / POW10[-exp10] : v * POW10[exp10];
+        *out = neg ? -v : v;
+    } else {
+        *out = strtod(start, NULL);
+    }
+    return true;
+}
+
+static bool skip_literal(sf_json_stream* s, const char* lit) {
+    size_t len = strlen(lit);
+    if ((size_t)(s->end - s->p) < len || memcmp(s->p, lit, len) != 0) return false;
+    s->p += len;
+    return true;
+}
+
+// Validates and skips any value
+static bool skip_value(sf_json_stream* s, u32 depth) {
+    if (depth > SF_STREAM_MAX_DEPTH) return false;
+    f64 unused;
+    switch (peek(s)) {
+        case '"': return skip_string(s);
+        case 't': return skip_literal(s, "true");
+        case 'f': return skip_literal(s, "false");
+        case 'n': return skip_literal(s, "null");
+        case '[':
+            s->p++;
+            if (accept(s, ']')) return true;
+            do { if (!skip_value(s, depth + 1)) return false; } while (accept(s, ','));
+            return accept(s, ']');
+        case '{':
+            s->p++;
+            if (accept(s, '}')) return true;
+            do {
+                if (!skip_string(s) || !accept(s, ':') || !skip_value(s, depth + 1)) return false;
+            } while (accept(s, ','));
+            return accept(s, '}');
+        default:
+            return read_number(s, &unused);
+    }
+}
+
+// --- Attribute Values ---
+
+// Small values as a document of their own, parsed by the regular JSON parser
+static sf_json_value* parse_span(sf_json_stream* s, const char* begin) {
+    size_t len = (size_t)(s->p - begin);
+    char* copy = SF_ARENA_PUSH(s->arena, char, len + 1);
+    memcpy(copy, begin, len);
+    copy[len] = '\0';
+    return sf_json_parse(copy, s->arena);
+}
+
+// Scalars and short number arrays are built on the stack; anything else is parsed as a span
+static bool read_small_value(sf_json_stream* s, sf_json_value* out, sf_json_value* items, sf_stream_buf* str, bool* done) {
+    memset(out, 0, sizeof(*out));
+    *done = true;
+    switch (peek(s)) {
+        case '"':
+            if (!read_string(s, str)) return false;
+            out->type = SF_JSON_VAL_STRING; out->as.s = str->data;
+            return true;
+        case 't': out->type = SF_JSON_VAL_BOOL; out->as.b = true; return skip_literal(s, "true");
+        case 'f': out->type = SF_JSON_VAL_BOOL; out->as.b = false; return skip_literal(s, "false");
+        case 'n': out->type = SF_JSON_VAL_NULL; return skip_literal(s, "null");
+        case '[': {
+            const char* begin = s->p++;
+            size_t count = 0;
+            if (!accept(s, ']')) {
+                do {
+                    char c = peek(s);
+                    if (count == SF_STREAM_SMALL_ARRAY || !(c == '-' || (c >= '0' && c <= '9'))) { s->p = begin; *done = false; return true; }
+                    memset(&items[count], 0, sizeof(items[count]));
+                    items[count].type = SF_JSON_VAL_NUMBER;
+                    if (!read_number(s, &items[count].as.n)) return false;
+                    count++;
+                } while (accept(s, ','));
+                if (!accept(s, ']')) return false;
+            }
+            out->type = SF_JSON_VAL_ARRAY; out->as.array.items = items; out->as.array.count = count;
+            return true;
+        }
+        case '{':
+            *done = false;
+            return true;
+        default:
+            out->type = SF_JSON_VAL_NUMBER;
+            return read_number(s, &out->as.n);
+    }
+}
+
+static void store_value(void* data, sf_dtype dtype, size_t i, f64 v) {
+    if (dtype == SF_DTYPE_F32) ((f32*)data)[i] = (f32)v;
+    else if (dtype == SF_DTYPE_I32) ((i32*)data)[i] = (i32)v;
+    else if (dtype == SF_DTYPE_U8) ((u8*)data)[i] = (u8)v;
+}
+
+// 'value' given as a flat number array, converted straight into the constant buffer (the
+// same result as handle_value + sf_ir_parse_data). Returns false in *flat for anything else.
+static bool read_flat_value(sf_json_stream* s, sf_ir_node* dst, bool* flat) {
+    *flat = false;
+    if (peek(s) != '[') return true;
+    const char* begin = s->p;
+
+    // 1. Count elements with the structural scanner; nested values take the general path
+    size_t count = 0;
+    bool empty = true;
+    for (const char* p = begin + 1; p < s->end;) {
+        const char* q = scan_array_special(p, s->end);
+        if (q >= s->end || *q == '[' || *q == '{' || *q == '"') return true;
+        for (const char* c = p; c < q && empty; ++c) empty = (*c == ' ' || *c == '\n' || *c == '\r' || *c == '\t');
+        if (*q == ']') { if (!empty) count++; break; }
+        count++;
+        p = q + 1;
+    }
+
+    // 2. Shape and buffer exactly like handle_value
+    if (dst->const_info.ndim == 0) {
+        dst->const_info.ndim = 1; dst->const_info.shape[0] = (int32_t)count;
+        sf_shape_calc_strides(&dst->const_info); dst->out_info = dst->const_info;
+    }
+    size_t elems = sf_shape_calc_count(dst->const_info.shape, dst->const_info.ndim);
+    if (elems == 0) elems = 1;
+    size_t bytes = elems * sf_dtype_size(dst->const_info.dtype);
+    dst->const_data = SF_ARENA_PUSH(s->arena, uint8_t, bytes);
+    if (bytes) memset(dst->const_data, 0, bytes);
+
+    // 3. Convert
+    s->p = begin + 1;
+    if (count == 0) { *flat = accept(s, ']'); return *flat; }
+    sf_dtype dtype = dst->const_info.dtype;
+    for (size_t i = 0; i < count; ++i) {
+        f64 v;
+        if (!read_number(s, &v)) return false;
+        if (i < elems) store_value(dst->const_data, dtype, i, v);
+        if (!accept(s, i + 1 < count ? ',' : ']')) return false;
+    }
+    *flat = true;
+    return true;
+}
+
+// --- Nodes ---
+
+static u32 id_lookup(sf_json_stream* s, const char* id, u32* slot_out) {
+    u32 slot = (u32)sf_hash64_str(id, SF_HASH64_SEED) & s->id_mask;
+    while (s->id_slots[slot]) {
+        u32 idx = s->id_slots[slot] - 1;
+        if (strcmp(s->ir->nodes[idx].id, id) == 0) { if (slot_out) *slot_out = slot; return idx; }
+        slot = (slot + 1) & s->id_mask;
+    }
+    if (slot_out) *slot_out = slot;
+    return UINT32_MAX;
+}
+
+static bool id_insert(sf_json_stream* s, u32 node_idx) {
+    // Keep the table at most half full
+    if ((node_idx + 1) * 2 > s->id_mask + 1) {
+        u32 new_size = (s->id_mask + 1) * 2;
+        u32* slots = calloc(new_size, sizeof(u32));
+        if (!slots) return false;
+        free(s->id_slots);
+        s->id_slots = slots;
+        s->id_mask = new_size - 1;
+        for (u32 i = 0; i < node_idx; ++i) {
+            u32 slot;
+            id_lookup(s, s->ir->nodes[i].id, &slot);
+            s->id_slots[slot] = i + 1;
+        }
+    }
+    u32 slot;
+    if (id_lookup(s, s->ir->nodes[node_idx].id, &slot) != UINT32_MAX) return false; // Duplicate ID
+    s->id_slots[slot] = node_idx + 1;
+    return true;
+}
+
+static sf_node_type lookup_type(sf_json_stream* s, const char* name) {
+    u32 slot = (u32)sf_hash64_str(name, SF_HASH64_SEED) & 63;
+    for (u32 probe = 0; probe < 64; ++probe, slot = (slot + 1) & 63) {
+        if (!s->type_names[slot]) {
+            sf_node_type type = sf_compiler_get_node_type(name);
+            s->type_names[slot] = sf_arena_strdup(s->arena, name);
+            s->type_values[slot] = type;
+            return type;
+        }
+        if (strcmp(s->type_names[slot], name) == 0) return s->type_values[slot];
+    }
+    return sf_compiler_get_node_type(name);
+}
+
+static sf_ir_node* create_node(sf_json_stream* s, sf_source_loc loc) {
+    sf_graph_ir* ir = s->ir;
+    if (ir->node_count == ir->node_cap) {
+        size_t cap = ir->node_cap * 2;
+        sf_ir_node* nodes = realloc(ir->nodes, sizeof(sf_ir_node) * cap);
+        if (!nodes) return NULL;
+        ir->nodes = nodes;
+        ir->node_cap = cap;
+    }
+
+    sf_node_type type = lookup_type(s, s->type.data);
+    const char* sub_path = NULL;
+    bool pending_import = false;
+    if (type == SF_NODE_UNKNOWN) {
+        // Imports may follow the nodes; those calls are resolved at the end
+        if (s->imports_seen) {
+            sub_path = sf_lower_find_import(s->imports, s->import_count, s->type.data, s->base_path, s->arena);
+            if (!sub_path) return NULL;
+        } else {
+            pending_import = true;
+        }
+        type = SF_NODE_CALL;
+    }
+
+    sf_ir_node* dst = sf_ir_node_add(ir, s->arena, s->id.data, type);
+    u32 idx = (u32)(dst - ir->nodes);
+    dst->loc = loc;
+    dst->sub_graph_path = sub_path;
+    dst->out_info.dtype = SF_DTYPE_UNKNOWN;
+    dst->const_info.dtype = SF_DTYPE_UNKNOWN;
+    if (!id_insert(s, idx)) return NULL;
+    if (pending_import && !list_push(&s->calls, idx, sf_arena_strdup(s->arena, s->type.data))) return NULL;
+    return dst;
+}
+
+static bool parse_data(sf_json_stream* s, u32 node_idx) {
+    if (peek(s) != '{') return skip_value(s, 1);
+    s->p++;
+    if (accept(s, '}')) return true;
+    sf_json_value items[SF_STREAM_SMALL_ARRAY];
+    bool seen_domain = false;
+    do {
+        if (!read_string(s, &s->key) || !accept(s, ':')) return false;
+        sf_ir_node* dst = &s->ir->nodes[node_idx];
+        const char* key = s->key.data;
+
+        if (strcmp(key, "value") == 0) {
+            bool flat;
+            if (!read_flat_value(s, dst, &flat)) return false;
+            if (flat) continue;
+        } else if (strcmp(key, "domain") == 0) {
+            // Resolved once every node exists; only the first 'domain' counts
+            if (peek(s) == '"' && !seen_domain) {
+                if (!read_string(s, &s->str[0])) return false;
+                if (!list_push(&s->domains, node_idx, sf_arena_strdup(s->arena, s->str[0].data))) return false;
+            } else if (!skip_value(s, 1)) {
+                return false;
+            }
+            seen_domain = true;
+            continue;
+        }
+
+        sf_json_value val;
+        bool done;
+        skip_ws(s);
+        const char* begin = s->p;
+        if (!read_small_value(s, &val, items, &s->str[0], &done)) return false;
+        if (!done) {
+            if (!skip_value(s, 1)) return false;
+            sf_json_value* doc = parse_span(s, begin);
+            if (!doc) return false;
+            val = *doc;
+        }
+        if (!sf_lower_node_attribute(dst, key, &val, s->base_path, s->arena, s->diag)) return false;
+    } while (accept(s, ','));
+    return accept(s, '}');
+}
+
+static bool parse_node(sf_json_stream* s) {
+    skip_ws(s);
+    sf_source_loc loc = current_loc(s);
+    if (!accept(s, '{')) return false;
+    bool has_id = false, has_type = false, has_data = false;
+    const char* deferred_data = NULL;
+    u32 node_idx = UINT32_MAX;
+
+    if (!accept(s, '}')) {
+        do {
+            if (!read_string(s, &s->key) || !accept(s, ':')) return false;
+            if (strcmp(s->key.data, "id") == 0 || strcmp(s->key.data, "type") == 0) {
+                bool is_id = s->key.data[0] == 'i';
+                if ((is_id ? has_id : has_type) || node_idx != UINT32_MAX) return false;
+                if (!read_string(s, is_id ? &s->id : &s->type)) return false;
+                *(is_id ? &has_id : &has_type) = true;
+            } else if (strcmp(s->key.data, "data") == 0) {
+                if (has_data) return false;
+                has_data = true;
+                if (has_id && has_type) {
+                    sf_ir_node* dst = create_node(s, loc);
+                    if (!dst) return false;
+                    node_idx = (u32)(dst - s->ir->nodes);
+                    if (!parse_data(s, node_idx)) return false;
+                } else {
+                    // Attributes need the node: come back once id and type are known
+                    skip_ws(s);
+                    deferred_data = s->p;
+                    if (!skip_value(s, 1)) return false;
+                }
+            } else if (!skip_value(s, 1)) {
+                return false;
+            }
+        } while (accept(s, ','));
+        if (!accept(s, '}')) return false;
+    }
+
+    if (!has_id || !has_type) return false;
+    if (node_idx == UINT32_MAX) {
+        sf_ir_node* dst = create_node(s, loc);
+        if (!dst) return false;
+        node_idx = (u32)(dst - s->ir->nodes);
+    }
+    if (deferred_data) {
+        const char* resume = s->p;
+        s->p = deferred_data;
+        if (!parse_data(s, node_idx)) return false;
+        s->p = resume;
+    }
+    return true;
+}
+
+// --- Links ---
+
+static bool push_link(sf_json_stream* s, const sf_stream_link* link) {
+    sf_stream_link* links = grow(s->links, &s->link_cap, s->link_count, sizeof(sf_stream_link));
+    if (!links) return false;
+    s->links = links;
+    s->links[s->link_count++] = *link;
+    return true;
+}
+
+static bool parse_link(sf_json_stream* s) {
+    static const char* KEYS[4] = { "src", "src_port", "dst", "dst_port" };
+    if (!accept(s, '{')) return false;
+    bool present[4] = { false, false, false, false };
+    if (!accept(s, '}')) {
+        do {
+            if (!read_string(s, &s->key) || !accept(s, ':')) return false;
+            int k = -1;
+            for (int i = 0; i < 4; ++i) if (strcmp(s->key.data, KEYS[i]) == 0) k = i;
+            if (k < 0) { if (!skip_value(s, 1)) return false; continue; }
+            if (present[k] || !read_string(s, &s->str[k])) return false;
+            present[k] = true;
+        } while (accept(s, ','));
+        if (!accept(s, '}')) return false;
+    }
+    if (!present[0] || !present[2]) return false;
+    const char* src_port = present[1] ? s->str[1].data : NULL;
+    const char* dst_port = present[3] ? s->str[3].data : NULL;
+
+    sf_stream_link link;
+    memset(&link, 0, sizeof(link));
+    u32 si = id_lookup(s, s->str[0].data, NULL);
+    u32 di = id_lookup(s, s->str[2].data, NULL);
+    if (!s->defer_links && si != UINT32_MAX && di != UINT32_MAX) {
+        // Both ends exist: connect now, in file order like sf_pass_lower
+        sf_builder_connect(s->ir, s->arena,
+            (sf_port){ si, sf_compiler_get_port_index(s->ir->nodes[si].type, src_port) },
+            (sf_port){ di, sf_compiler_get_port_index(s->ir->nodes[di].type, dst_port) });
+        return true;
+    }
+    s->defer_links = true;
+    for (int i = 0; i < 4; ++i) link.ids[i] = present[i] ? sf_arena_strdup(s->arena, s->str[i].data) : NULL;
+    return push_link(s, &link);
+}
+
+// --- Document ---
+
+static bool parse_array(sf_json_stream* s, bool (*element)(sf_json_stream*)) {
+    if (!accept(s, '[')) return false;
+    if (accept(s, ']')) return true;
+    do { if (!element(s)) return false; } while (accept(s, ','));
+    return accept(s, ']');
+}
+
+static bool parse_imports(sf_json_stream* s) {
+    if (!accept(s, '[')) return false;
+    u32 cap = 0;
+    if (!accept(s, ']')) {
+        do {
+            if (!read_string(s, &s->str[0])) return false;
+            if (s->import_count == cap) {
+                u32 new_cap = cap ? cap * 2 : 16;
+                const char** imports = SF_ARENA_PUSH(s->arena, const char*, new_cap);
+                if (s->import_count) memcpy(imports, s->imports, sizeof(const char*) * s->import_count);
+                s->imports = imports;
+                cap = new_cap;
+            }
+            s->imports[s->import_count++] = sf_arena_strdup(s->arena, s->str[0].data);
+        } while (accept(s, ','));
+        if (!accept(s, ']')) return false;
+    }
+    s->imports_seen = true;
+    return true;
+}
+
+static bool parse_document(sf_json_stream* s) {
+    bool seen_nodes = false, seen_links = false;
+    if (!accept(s, '{')) return false;
+    if (!accept(s, '}')) {
+        do {
+            skip_ws(s);
+            const char* member = s->p;
+            if (!read_string(s, &s->key) || !accept(s, ':')) return false;
+            if (strcmp(s->key.data, "nodes") == 0) {
+                if (seen_nodes || !parse_array(s, parse_node)) return false;
+                seen_nodes = true;
+            } else if (strcmp(s->key.data, "links") == 0) {
+                if (seen_links || !parse_array(s, parse_link)) return false;
+                seen_links = true;
+            } else if (strcmp(s->key.data, "imports") == 0) {
+                if (s->imports_seen || !parse_imports(s)) return false;
+            } else {
+                if (!skip_value(s, 1)) return false;
+                const char** rest = grow(s->rest, &s->rest_cap, s->rest_count + 1, sizeof(const char*));
+                if (!rest) return false;
+                s->rest = rest;
+                s->rest[s->rest_count++] = member;
+                s->rest[s->rest_count++] = s->p;
+            }
+        } while (accept(s, ','));
+        if (!accept(s, '}')) return false;
+    }
+    skip_ws(s);
+    return seen_nodes && s->p == s->end;
+}
+
+// Everything that needs the complete node set: imports, domains, deferred links, settings
+static bool finish(sf_json_stream* s) {
+    sf_graph_ir* ir = s->ir;
+    for (u32 i = 0; i < s->calls.count; ++i) {
+        sf_ir_node* node = &ir->nodes[s->calls.items[i].node_idx];
+        const char* sub_path = sf_lower_find_import(s->imports, s->import_count, s->calls.items[i].ref, s->base_path, s->arena);
+        if (!sub_path) return false;
+        // A 'path' attribute set while parsing takes precedence, as in sf_pass_lower
+        if (!node->sub_graph_path) node->sub_graph_path = sub_path;
+    }
+    for (u32 i = 0; i < s->domains.count; ++i) {
+        u32 di = id_lookup(s, s->domains.items[i].ref, NULL);
+        if (di != UINT32_MAX) ir->nodes[s->domains.items[i].node_idx].domain_node_idx = di;
+    }
+    for (u32 i = 0; i < s->link_count; ++i) {
+        const sf_stream_link* l = &s->links[i];
+        u32 si = id_lookup(s, l->ids[0], NULL);
+        u32 di = id_lookup(s, l->ids[2], NULL);
+        if (si == UINT32_MAX || di == UINT32_MAX) continue;
+        sf_builder_connect(ir, s->arena,
+            (sf_port){ si, sf_compiler_get_port_index(ir->nodes[si].type, l->ids[1]) },
+            (sf_port){ di, sf_compiler_get_port_index(ir->nodes[di].type, l->ids[3]) });
+    }
+
+    // Remaining members as their own small document
+    size_t size = 3;
+    for (u32 i = 0; i < s->rest_count; i += 2) size += (size_t)(s->rest[i + 1] - s->rest[i]) + 1;
+    char* doc = SF_ARENA_PUSH(s->arena, char, size);
+    size_t o = 0;
+    doc[o++] = '{';
+    for (u32 i = 0; i < s->rest_count; i += 2) {
+        if (i) doc[o++] = ',';
+        size_t len = (size_t)(s->rest[i + 1] - s->rest[i]);
+        memcpy(doc + o, s->rest[i], len);
+        o += len;
+    }
+    doc[o++] = '}';
+    doc[o] = '\0';
+    sf_json_value* root = sf_json_parse(doc, s->arena);
+    if (!root) return false;
+    sf_ir_parse_window_settings(root, ir);
+    return true;
+}
+
+bool sf_pass_lower_stream(const char* json, size_t json_size, sf_graph_ir* out_ir, sf_arena* arena, const char* base_path, sf_compiler_diag* diag) {
+    sf_json_stream s;
+    memset(&s, 0, sizeof(s));
+    s.p = json;
+    s.end = json + json_size;
+    s.line_pos = json;
+    s.line_start = json;
+    s.line = 1;
+    s.arena = arena;
+    s.base_path = base_path;
+    s.loc_file = base_path ? sf_arena_strdup(arena, base_path) : "unknown";
+    // Attribute handlers report into a muted buffer: replayed into 'diag' only when streaming
+    // succeeds, because the AST fallback reports the same warnings again itself
+    sf_compiler_diag pending;
+    sf_compiler_diag_init(&pending, arena);
+    pending.muted = true;
+    s.diag = &pending;
+
+    // Node array and scratch tables live on the heap while parsing, so growing them does not
+    // leave dead copies in the arena; the final array is moved into the arena once.
+    memset(out_ir, 0, sizeof(sf_graph_ir));
+    sf_graph_ir ir;
+    memset(&ir, 0, sizeof(ir));
+    ir.node_cap = 1024;
+    ir.nodes = malloc(sizeof(sf_ir_node) * ir.node_cap);
+    s.ir = &ir;
+    s.id_mask = 2047;
+    s.id_slots = calloc(s.id_mask + 1, sizeof(u32));
+
+    bool ok = ir.nodes && s.id_slots && parse_document(&s) && finish(&s);
+    if (ok) {
+        size_t cap = ir.node_count + 128; // Same headroom as sf_pass_lower
+        sf_ir_node* nodes = SF_ARENA_PUSH(arena, sf_ir_node, cap);
+        ok = nodes != NULL;
+        if (ok) {
+            memcpy(nodes, ir.nodes, sizeof(sf_ir_node) * ir.node_count);
+            *out_ir = ir;
+            out_ir->nodes = nodes;
+            out_ir->node_cap = cap;
+        }
+    }
+    if (ok) {
+        u32 kept = pending.error_count < pending.error_capacity ? pending.error_count : pending.error_capacity;
+        for (u32 i = 0; i < kept; ++i) sf_compiler_diag_report(diag, pending.errors[i].loc, "%s", pending.errors[i].message);
+    } else {
+        SF_LOG_DEBUG("Streaming lowering not applicable to %s, using the AST path", base_path ? base_path : "graph");
+    }
+
+    free(ir.nodes);
+    free(s.id_slots);
+    free(s.links);
+    free(s.domains.items);
+    free(s.calls.items);
+    free(s.rest);
+    free(s.key.data); free(s.id.data); free(s.type.data);
+    for (int i = 0; i < 4; ++i) free(s.str[i].data);
+    return ok;
+}
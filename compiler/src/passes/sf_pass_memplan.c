@@ -0,0 +1,174 @@
+#include "../sf_passes.h"
+#include "../sf_compiler_internal.h"
+#include <sionflow/base/sf_log.h>
+#include <sionflow/base/sf_shape.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Memory Planning Pass
+ * Assigns every runtime tensor an aligned offset inside one contiguous buffer.
+ * Lifetimes come from the sorted schedule; tensors are placed largest first, each into
+ * the tightest gap left by the already placed tensors whose lifetimes overlap it
+ * (greedy-by-size interval coloring).
+ * The tiles of one task run in parallel and barriers only order register dependencies, so
+ * a lifetime always extends to the end of the task that last touches the register: bytes
+ * are only reused across task boundaries.
+ */
+
+typedef struct {
+    u64 size;   // Aligned byte size
+    u64 offset;
+    u32 start;  // First and last schedule position the register is live
+    u32 end;
+    u16 reg;
+} sf_mem_block;
+
+static int compare_blocks(const void* a, const void* b) {
+    const sf_mem_block* x = (const sf_mem_block*)a;
+    const sf_mem_block* y = (const sf_mem_block*)b;
+    if (x->size != y->size) return x->size > y->size ? -1 : 1;
+    if (x->start != y->start) return x->start < y->start ? -1 : 1;
+    return (int)x->reg - (int)y->reg;
+}
+
+static u64 align_up(u64 v, u64 alignment) {
+    return (v + alignment - 1) & ~(alignment - 1);
+}
+
+// Last schedule position of the task each position belongs to (the position itself for nodes
+// that emit no instruction). Mirrors how task_plan walks the schedule.
+static u32* task_end_positions(const sf_pass_ctx* ctx, sf_arena* arena) {
+    u32 count = (u32)ctx->sorted_count;
+    u32* task_end = SF_ARENA_PUSH(arena, u32, count ? count : 1);
+    u32* task_of = SF_ARENA_PUSH(arena, u32, count ? count : 1);
+    u32* last_pos = SF_ARENA_PUSH(arena, u32, ctx->task_count ? ctx->task_count : 1);
+    u32 instr = 0, t = 0;
+    for (u32 p = 0; p < count; ++p) {
+        const sf_ir_node* node = ctx->sorted_nodes[p];
+        task_of[p] = UINT32_MAX;
+        if (node->type == SF_NODE_UNKNOWN || node->type == SF_NODE_INPUT ||
+            node->type == SF_NODE_OUTPUT || node->type == SF_NODE_CONST) continue;
+        while (t + 1 < ctx->task_count && instr >= ctx->tasks[t + 1].start_inst) t++;
+        if (t < ctx->task_count) { task_of[p] = t; last_pos[t] = p; }
+        instr++;
+    }
+    for (u32 p = 0; p < count; ++p) task_end[p] = task_of[p] == UINT32_MAX ? p : last_pos[task_of[p]];
+    return task_end;
+}
+
+bool sf_pass_memplan(sf_pass_ctx* ctx, sf_compiler_diag* diag) {
+    sf_graph_ir* ir = ctx->ir;
+    sf_arena* arena = ctx->arena;
+    sf_ir_node** sorted = ctx->sorted_nodes;
+    u32 count = (u32)ctx->sorted_count;
+
+    u32 alignment = ctx->options->tensor_alignment ? ctx->options->tensor_alignment : SF_DEFAULT_TENSOR_ALIGNMENT;
+    if (alignment & (alignment - 1)) {
+        SF_REPORT(diag, NULL, "Memory Planning: Tensor alignment %u is not a power of two", alignment);
+        return false;
+    }
+
+    // Same register space as codegen
+    u16 max_reg = 0;
+    for (size_t i = 0; i < ir->node_count; ++i) {
+        if (ir->nodes[i].type != SF_NODE_UNKNOWN && ir->nodes[i].out_reg_idx > max_reg) max_reg = ir->nodes[i].out_reg_idx;
+    }
+    u32 reg_count = (u32)max_reg + 1;
+
+    sf_memory_plan* plan = &ctx->memory;
+    plan->alignment = alignment;
+    plan->tensor_count = reg_count;
+    plan->arena_size = 0;
+    plan->offsets = SF_ARENA_PUSH(arena, u64, reg_count);
+    for (u32 r = 0; r < reg_count; ++r) plan->offsets[r] = SF_MEMORY_UNPLANNED;
+
+    // 1. Lifetimes and sizes per register
+    sf_mem_block* blocks = SF_ARENA_PUSH(arena, sf_mem_block, reg_count);
+    u8* excluded = SF_ARENA_PUSH(arena, u8, reg_count);
+    memset(excluded, 0, reg_count);
+    for (u32 r = 0; r < reg_count; ++r) {
+        blocks[r] = (sf_mem_block){ .size = 0, .offset = 0, .start = UINT32_MAX, .end = 0, .reg = (u16)r };
+    }
+
+    u32* task_end = task_end_positions(ctx, arena);
+    for (u32 p = 0; p < count; ++p) {
+        sf_ir_node* node = sorted[p];
+        if (node->type == SF_NODE_UNKNOWN) continue;
+        sf_mem_block* b = &blocks[node->out_reg_idx];
+        u32 end = task_end[p];
+
+        if (b->start == UINT32_MAX) b->start = p;
+        if (b->end < end) b->end = end;
+        // The buffer must fit every value the register holds (views included)
+        bool is_static = true;
+        for (u8 d = 0; d < node->out_info.ndim; ++d) if (node->out_info.shape[d] <= 0) is_static = false;
+        if (!is_static) excluded[b->reg] = 1;
+        else {
+            u64 bytes = (u64)sf_shape_calc_count(node->out_info.shape, node->out_info.ndim) * sf_dtype_size(node->out_info.dtype);
+            if (bytes > b->size) b->size = bytes;
+        }
+
+        // Constants live in the program, INPUT/OUTPUT are bound to external buffers
+        if (node->type == SF_NODE_CONST || node->type == SF_NODE_INPUT || node->type == SF_NODE_OUTPUT) excluded[b->reg] = 1;
+        // Persistent resources keep their contents for the whole run
+        if (node->resource_flags) { b->start = 0; b->end = count; }
+
+        for (u32 k = 0; k < 4; ++k) {
+            u32 src = node->inputs[k].src_node_idx;
+            if (src == UINT32_MAX) continue;
+            sf_mem_block* sb = &blocks[ir->nodes[src].out_reg_idx];
+            if (sb->end < end) sb->end = end;
+        }
+        if (node->domain_node_idx != UINT32_MAX) {
+            sf_mem_block* db = &blocks[ir->nodes[node->domain_node_idx].out_reg_idx];
+            if (db->end < end) db->end = end;
+        }
+    }
+
+    // 2. Candidates, largest first
+    u32 candidate_count = 0;
+    u64 unshared_size = 0;
+    for (u32 r = 0; r < reg_count; ++r) {
+        if (excluded[r] || blocks[r].start == UINT32_MAX || blocks[r].size == 0) continue;
+        blocks[r].size = align_up(blocks[r].size, alignment);
+        unshared_size += blocks[r].size;
+        blocks[candidate_count++] = blocks[r];
+    }
+    qsort(blocks, candidate_count, sizeof(sf_mem_block), compare_blocks);
+
+    // 3. Best-fit placement. 'placed' stays ordered by offset so gaps are found in one sweep.
+    u32* placed = SF_ARENA_PUSH(arena, u32, candidate_count ? candidate_count : 1);
+    u32 placed_count = 0;
+    for (u32 i = 0; i < candidate_count; ++i) {
+        sf_mem_block* b = &blocks[i];
+        u64 best_offset = UINT64_MAX, best_gap = UINT64_MAX;
+        u64 cursor = 0;
+        u32 insert_at = placed_count;
+
+        for (u32 j = 0; j < placed_count; ++j) {
+            const sf_mem_block* o = &blocks[placed[j]];
+            if (o->end < b->start || b->end < o->start) continue; // Disjoint lifetimes may share bytes
+            if (o->offset >= cursor + b->size && o->offset - cursor < best_gap) {
+                best_gap = o->offset - cursor;
+                best_offset = cursor;
+            }
+            if (o->offset + o->size > cursor) cursor = o->offset + o->size;
+        }
+        b->offset = (best_offset != UINT64_MAX) ? best_offset : cursor;
+
+        for (u32 j = 0; j < placed_count; ++j) {
+            if (blocks[placed[j]].offset > b->offset) { insert_at = j; break; }
+        }
+        memmove(&placed[insert_at + 1], &placed[insert_at], sizeof(u32) * (placed_count - insert_at));
+        placed[insert_at] = i;
+        placed_count++;
+
+        plan->offsets[b->reg] = b->offset;
+        if (b->offset + b->size > plan->arena_size) plan->arena_size = b->offset + b->size;
+    }
+
+    SF_LOG_INFO("Memory Planning: %u tensors packed into %llu bytes (%llu without sharing)",
+        candidate_count, (unsigned long long)plan->arena_size, (unsigned long long)unshared_size);
+    return true;
+}
@@ -0,0 +1,178 @@
+#include "../sf_passes.h"
+#include "../sf_graph_utils.h"
+#include "../sf_compiler_internal.h"
+#include <sionflow/base/sf_log.h>
+#include <string.h>
+
+/**
+ * Reassociation Pass
+ * Rebalances chains of one ASSOCIATIVE op (((a + b) + c) + d) into log-depth trees
+ * ((a + b) + (c + d)). The chain's own nodes are rewired, the operand order is kept, so
+ * commutativity is not required. Intermediate nodes must have no other consumers.
+ * Floating point chains are left alone under options->strict_fp: rounding depends on order.
+ */
+
+typedef struct {
+    sf_port* leaves;
+    u32 leaf_count;
+    u32* interior; // Pre-order, interior[0] is the root
+    u32 interior_count;
+} sf_chain;
+
+static bool same_info(const sf_type_info* a, const sf_type_info* b) {
+    return a->dtype == b->dtype && a->ndim == b->ndim &&
+           memcmp(a->shape, b->shape, sizeof(a->shape[0]) * a->ndim) == 0;
+}
+
+static bool can_broadcast_to(const sf_type_info* src, const sf_type_info* dst) {
+    if (src->ndim > dst->ndim) return false;
+    for (int i = 0; i < src->ndim; ++i) {
+        i32 s = src->shape[src->ndim - 1 - i];
+        i32 d = dst->shape[dst->ndim - 1 - i];
+        if (s != d && s != 1) return false;
+    }
+    return true;
+}
+
+// Shape of op(a, b) when both broadcast onto the chain's result
+static sf_type_info broadcast_info(const sf_type_info* a, const sf_type_info* b, sf_dtype dtype) {
+    sf_type_info out = {0};
+    out.dtype = dtype;
+    out.ndim = a->ndim > b->ndim ? a->ndim : b->ndim;
+    for (int i = 0; i < out.ndim; ++i) {
+        i32 sa = i < a->ndim ? a->shape[a->ndim - 1 - i] : 1;
+        i32 sb = i < b->ndim ? b->shape[b->ndim - 1 - i] : 1;
+        out.shape[out.ndim - 1 - i] = sa == 1 ? sb : sa;
+    }
+    return out;
+}
+
+static bool single_user(const sf_ir_node* node) {
+    return node->users && !node->users->next;
+}
+
+// Part of the chain below 'parent': same op, same result and nobody else reads it
+static bool is_interior(const sf_graph_ir* ir, u32 idx, const sf_ir_node* root) {
+    const sf_ir_node* n = &ir->nodes[idx];
+    return n->type == root->type && single_user(n) && !n->resource_flags && same_info(&n->out_info, &root->out_info);
+}
+
+static bool is_chain_root(const sf_graph_ir* ir, const sf_ir_node* node) {
+    if (!single_user(node)) return true;
+    const sf_ir_node* user = &ir->nodes[node->users->node_idx];
+    return user->type != node->type || user->resource_flags || !same_info(&user->out_info, &node->out_info);
+}
+
+// Leaves left to right plus the chain depth, walking with an explicit stack
+static u32 collect_chain(sf_graph_ir* ir, u32 root_idx, sf_chain* chain, u32* stack, u32* depth) {
+    const sf_ir_node* root = &ir->nodes[root_idx];
+    u32 top = 0;
+    stack[top++] = root_idx;
+    chain->leaf_count = 0;
+    chain->interior_count = 0;
+    while (top > 0) {
+        u32 idx = stack[--top];
+        chain->interior[chain->interior_count++] = idx;
+        // Push 'b' first so 'a' (and its leaves) come out first
+        for (int p = 1; p >= 0; --p) {
+            sf_port src = sf_builder_get_source(ir, (sf_port){ idx, (u32)p });
+            if (SF_PORT_IS_NULL(src)) return 0; // Incomplete node: leave the chain alone
+            if (src.node_idx != root_idx && is_interior(ir, src.node_idx, root)) stack[top++] = src.node_idx;
+        }
+    }
+    // Leaves in order: revisit the pre-order and emit non-interior operands a before b
+    for (u32 i = 0; i < chain->interior_count; ++i) depth[chain->interior[i]] = 0;
+    u32 max_depth = 0;
+    for (u32 i = chain->interior_count; i-- > 0;) {
+        u32 idx = chain->interior[i];
+        u32 d = 0;
+        for (u32 p = 0; p < 2; ++p) {
+            sf_port src = sf_builder_get_source(ir, (sf_port){ idx, p });
+            if (src.node_idx != root_idx && is_interior(ir, src.node_idx, root) && depth[src.node_idx] > d) d = depth[src.node_idx];
+        }
+        depth[idx] = d + 1;
+        if (depth[idx] > max_depth) max_depth = depth[idx];
+    }
+    top = 0;
+    stack[top++] = root_idx;
+    while (top > 0) {
+        u32 idx = stack[--top];
+        if (idx & 0x80000000u) { // Marker: emit leaf 'b' of this node after its 'a' subtree
+            idx &= 0x7FFFFFFFu;
+            sf_port b = sf_builder_get_source(ir, (sf_port){ idx, 1 });
+            if (is_interior(ir, b.node_idx, root) && b.node_idx != root_idx) stack[top++] = b.node_idx;
+            else chain->leaves[chain->leaf_count++] = b;
+            continue;
+        }
+        stack[top++] = idx | 0x80000000u;
+        sf_port a = sf_builder_get_source(ir, (sf_port){ idx, 0 });
+        if (is_interior(ir, a.node_idx, root) && a.node_idx != root_idx) stack[top++] = a.node_idx;
+        else chain->leaves[chain->leaf_count++] = a;
+    }
+    return max_depth;
+}
+
+// Rebuilds leaves [lo, hi) as a balanced subtree on the next free interior node
+static sf_port build_balanced(sf_graph_ir* ir, sf_arena* arena, const sf_chain* chain, u32 lo, u32 hi, u32* next_interior, sf_dtype dtype) {
+    if (hi - lo == 1) return chain->leaves[lo];
+    u32 idx = chain->interior[(*next_interior)++];
+    u32 mid = lo + (hi - lo) / 2;
+    sf_port a = build_balanced(ir, arena, chain, lo, mid, next_interior, dtype);
+    sf_port b = build_balanced(ir, arena, chain, mid, hi, next_interior, dtype);
+    sf_builder_connect(ir, arena, a, (sf_port){ idx, 0 });
+    sf_builder_connect(ir, arena, b, (sf_port){ idx, 1 });
+    ir->nodes[idx].out_info = broadcast_info(&ir->nodes[a.node_idx].out_info, &ir->nodes[b.node_idx].out_info, dtype);
+    return (sf_port){ idx, 0 };
+}
+
+static u32 ceil_log2(u32 n) {
+    u32 d = 0;
+    while ((1u << d) < n) d++;
+    return d;
+}
+
+bool sf_pass_reassociate(sf_pass_ctx* ctx, sf_compiler_diag* diag) {
+    sf_graph_ir* ir = ctx->ir;
+    sf_arena* arena = ctx->arena;
+    if (!ctx->sorted_nodes || ir->node_count == 0) return true;
+    bool strict_fp = ctx->options && ctx->options->strict_fp;
+
+    u32 node_count = (u32)ir->node_count;
+    sf_chain chain;
+    chain.leaves = SF_ARENA_PUSH(arena, sf_port, node_count + 1);
+    chain.interior = SF_ARENA_PUSH(arena, u32, node_count);
+    u32* stack = SF_ARENA_PUSH(arena, u32, node_count * 2);
+    u32* depth = SF_ARENA_PUSH(arena, u32, node_count);
+
+    u32 rebalanced = 0;
+    for (size_t i = 0; i < ctx->sorted_count; ++i) {
+        sf_ir_node* node = ctx->sorted_nodes[i];
+        u32 idx = (u32)(node - ir->nodes);
+        if (node->type == SF_NODE_UNKNOWN || !(SF_COMPILER_NODE_TRAITS[node->type] & SF_NODE_TRAIT_ASSOCIATIVE)) continue;
+        if (node->resource_flags || !is_chain_root(ir, node)) continue;
+        if (strict_fp && node->out_info.dtype == SF_DTYPE_F32) continue;
+
+        u32 chain_depth = collect_chain(ir, idx, &chain, stack, depth);
+        if (chain.leaf_count < 4 || chain_depth <= ceil_log2(chain.leaf_count)) continue;
+
+        // Every operand must broadcast onto the result, so any pairing has a valid shape
+        bool ok = true;
+        for (u32 l = 0; l < chain.leaf_count && ok; ++l) {
+            ok = can_broadcast_to(&ir->nodes[chain.leaves[l].node_idx].out_info, &node->out_info);
+        }
+        if (!ok) continue;
+
+        sf_type_info root_info = node->out_info;
+        for (u32 n = 0; n < chain.interior_count; ++n) {
+            for (u32 p = 0; p < 2; ++p) sf_builder_disconnect(ir, (sf_port){ chain.interior[n], p });
+        }
+        u32 next_interior = 0;
+        build_balanced(ir, arena, &chain, 0, chain.leaf_count, &next_interior, root_info.dtype);
+        ir->nodes[idx].out_info = root_info;
+        rebalanced++;
+    }
+
+    if (rebalanced == 0) return true;
+    SF_LOG_DEBUG("Reassociation: rebalanced %u chains", rebalanced);
+    return sf_pass_sort(ctx, diag); // Rewired nodes need a new topological order
+}
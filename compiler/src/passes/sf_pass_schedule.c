@@ -0,0 +1,279 @@
+#include "../sf_passes.h"
+#include "../sf_compiler_internal.h"
+#include <sionflow/base/sf_log.h>
+#include <sionflow/base/sf_shape.h>
+#include <string.h>
+
+/**
+ * Scheduling Pass
+ * List scheduling over the dependency graph with one of two priorities:
+ * - Cluster: nodes sharing a domain and strategy run back to back. Task planning opens a
+ *   new task whenever either changes, so this means fewer, larger tasks. Keep drawing ready
+ *   nodes from the current bucket, switch buckets only when it runs dry.
+ * - Min-memory: greedily run the ready node that grows the live intermediate bytes the
+ *   least (or frees the most), using out_info sizes.
+ * Ties always go to the earlier position in the incoming order, which keeps the result
+ * deterministic. The peak of live intermediate bytes is reported for either mode.
+ * Views (reshapes, slices) own no bytes: they keep their source buffer alive until the
+ * view's last consumer ran.
+ */
+
+// --- Min-Heap of schedule positions ---
+
+typedef struct {
+    u32* items;
+    u32 count;
+    u32 cap;
+} sf_pos_heap;
+
+static void heap_push(sf_pos_heap* h, sf_arena* arena, u32 v) {
+    if (h->count == h->cap) {
+        u32 cap = h->cap ? h->cap * 2 : 8;
+        u32* items = SF_ARENA_PUSH(arena, u32, cap);
+        if (h->count) memcpy(items, h->items, sizeof(u32) * h->count);
+        h->items = items; h->cap = cap;
+    }
+    u32 i = h->count++;
+    while (i > 0 && h->items[(i - 1) / 2] > v) { h->items[i] = h->items[(i - 1) / 2]; i = (i - 1) / 2; }
+    h->items[i] = v;
+}
+
+static u32 heap_pop(sf_pos_heap* h) {
+    u32 top = h->items[0];
+    u32 last = h->items[--h->count];
+    u32 i = 0;
+    for (;;) {
+        u32 c = i * 2 + 1;
+        if (c >= h->count) break;
+        if (c + 1 < h->count && h->items[c + 1] < h->items[c]) c++;
+        if (h->items[c] >= last) break;
+        h->items[i] = h->items[c]; i = c;
+    }
+    if (h->count) h->items[i] = last;
+    return top;
+}
+
+// Nodes that do not become instructions never open a task
+static bool is_instruction(const sf_ir_node* node) {
+    return node->type != SF_NODE_UNKNOWN && node->type != SF_NODE_INPUT &&
+           node->type != SF_NODE_OUTPUT && node->type != SF_NODE_CONST;
+}
+
+static bool is_view(const sf_ir_node* node) {
+    return node->type == SF_NODE_RESHAPE || node->type == SF_NODE_SLICE;
+}
+
+// Bytes a node adds to the working set. Views share their source buffer; constants and
+// inputs live outside of it.
+static u64 node_bytes(const sf_ir_node* node) {
+    if (!is_instruction(node) || is_view(node)) return 0;
+    u64 count = 1;
+    for (u8 d = 0; d < node->out_info.ndim; ++d) {
+        if (node->out_info.shape[d] <= 0) return 0; // Unknown until runtime
+        count *= (u64)node->out_info.shape[d];
+    }
+    return count * sf_dtype_size(node->out_info.dtype);
+}
+
+// Buffer that input 'k' of 'p' reads (UINT32_MAX for nodes outside the schedule, and for
+// the edge through which a view aliases its source: that edge consumes nothing)
+static u32 input_owner(sf_ir_node** sorted, const u32* pos_of, const u32* owner, u32 p, u32 k) {
+    u32 src = sorted[p]->inputs[k].src_node_idx;
+    if (src == UINT32_MAX || pos_of[src] == UINT32_MAX) return UINT32_MAX;
+    if (k == 0 && owner[p] != p) return UINT32_MAX;
+    return owner[pos_of[src]];
+}
+
+// Live bytes before/after running 'p': its result appears, buffers whose last reader it is go away
+static i64 schedule_delta(sf_ir_node** sorted, const u32* pos_of, const u32* owner, const u32* remaining, const u64* bytes, u32 p) {
+    i64 delta = (i64)bytes[p];
+    for (u32 k = 0; k < 4; ++k) {
+        u32 o = input_owner(sorted, pos_of, owner, p, k);
+        if (o == UINT32_MAX) continue;
+        bool seen = false;
+        u32 edges = 0;
+        for (u32 j = 0; j < 4; ++j) {
+            if (input_owner(sorted, pos_of, owner, p, j) != o) continue;
+            if (j < k) seen = true;
+            edges++;
+        }
+        if (!seen && remaining[o] == edges) delta -= (i64)bytes[o];
+    }
+    return delta;
+}
+
+// Runs 'p' against the per-buffer reader counts; returns the bytes freed
+static u64 retire_inputs(sf_ir_node** sorted, const u32* pos_of, const u32* owner, u32* remaining, const u64* bytes, u32 p) {
+    u64 freed = 0;
+    for (u32 k = 0; k < 4; ++k) {
+        u32 o = input_owner(sorted, pos_of, owner, p, k);
+        if (o != UINT32_MAX && --remaining[o] == 0) freed += bytes[o];
+    }
+    if (owner[p] == p && remaining[p] == 0) freed += bytes[p]; // Nobody reads it
+    return freed;
+}
+
+// Peak working set of a finished order: a buffer stays live until its last reader ran
+static u64 measure_peak(sf_ir_node** order, u32 count, sf_graph_ir* ir, const u32* pos_of, const u32* owner, const u32* uses, const u64* bytes, sf_arena* arena) {
+    u32* remaining = SF_ARENA_PUSH(arena, u32, count);
+    memcpy(remaining, uses, sizeof(u32) * count);
+    u32* at = SF_ARENA_PUSH(arena, u32, count);
+    for (u32 i = 0; i < count; ++i) at[i] = pos_of[order[i] - ir->nodes];
+    sf_ir_node** sorted = SF_ARENA_PUSH(arena, sf_ir_node*, count);
+    for (u32 i = 0; i < count; ++i) sorted[at[i]] = order[i];
+    u64 live = 0, peak = 0;
+    for (u32 i = 0; i < count; ++i) {
+        u32 p = at[i];
+        live += bytes[p];
+        if (live > peak) peak = live;
+        live -= retire_inputs(sorted, pos_of, owner, remaining, bytes, p);
+    }
+    return peak;
+}
+
+// Open-addressing map from (domain, strategy) to a dense bucket id
+static u32 bucket_of(u64* keys, u32* ids, u32 mask, u32* bucket_count, u64 key) {
+    u32 slot = (u32)(sf_hash64(&key, sizeof(key), SF_HASH64_SEED) & mask);
+    while (ids[slot] != UINT32_MAX && keys[slot] != key) slot = (slot + 1) & mask;
+    if (ids[slot] == UINT32_MAX) { keys[slot] = key; ids[slot] = (*bucket_count)++; }
+    return ids[slot];
+}
+
+bool sf_pass_schedule(sf_pass_ctx* ctx, sf_compiler_diag* diag) {
+    sf_graph_ir* ir = ctx->ir;
+    sf_arena* arena = ctx->arena;
+    sf_ir_node** sorted = ctx->sorted_nodes;
+    u32 count = (u32)ctx->sorted_count;
+    if (!sorted || count < 2) return true;
+
+    // 1. Dependency graph over positions (CSR of consumers, built from inputs)
+    u32* pos_of = SF_ARENA_PUSH(arena, u32, ir->node_count);
+    for (size_t i = 0; i < ir->node_count; ++i) pos_of[i] = UINT32_MAX;
+    for (u32 p = 0; p < count; ++p) pos_of[sorted[p] - ir->nodes] = p;
+
+    u32* indegree = SF_ARENA_PUSH(arena, u32, count);
+    u32* succ_start = SF_ARENA_PUSH(arena, u32, count + 1);
+    memset(indegree, 0, sizeof(u32) * count);
+    memset(succ_start, 0, sizeof(u32) * (count + 1));
+    for (u32 p = 0; p < count; ++p) {
+        for (u32 k = 0; k < 4; ++k) {
+            u32 src = sorted[p]->inputs[k].src_node_idx;
+            if (src == UINT32_MAX || pos_of[src] == UINT32_MAX) continue;
+            indegree[p]++;
+            succ_start[pos_of[src] + 1]++;
+        }
+    }
+    for (u32 p = 0; p < count; ++p) succ_start[p + 1] += succ_start[p];
+    u32* succ = SF_ARENA_PUSH(arena, u32, succ_start[count] ? succ_start[count] : 1);
+    u32* fill = SF_ARENA_PUSH(arena, u32, count);
+    memcpy(fill, succ_start, sizeof(u32) * count);
+    for (u32 p = 0; p < count; ++p) {
+        for (u32 k = 0; k < 4; ++k) {
+            u32 src = sorted[p]->inputs[k].src_node_idx;
+            if (src == UINT32_MAX || pos_of[src] == UINT32_MAX) continue;
+            succ[fill[pos_of[src]]++] = p;
+        }
+    }
+
+    // 2. Buckets
+    u32 table_size = 16;
+    while (table_size < count * 2) table_size *= 2;
+    u64* keys = SF_ARENA_PUSH(arena, u64, table_size);
+    u32* ids = SF_ARENA_PUSH(arena, u32, table_size);
+    for (u32 i = 0; i < table_size; ++i) ids[i] = UINT32_MAX;
+    u32* bucket = SF_ARENA_PUSH(arena, u32, count);
+    u32 bucket_count = 0;
+    for (u32 p = 0; p < count; ++p) {
+        const sf_ir_node* node = sorted[p];
+        if (!is_instruction(node)) { bucket[p] = UINT32_MAX; continue; }
+        u64 key = ((u64)node->domain_node_idx << 8) | SF_OP_METADATA[node->type].strategy;
+        bucket[p] = bucket_of(keys, ids, table_size - 1, &bucket_count, key);
+    }
+
+    // Buffers: a view reads through to the buffer its source lives in. 'uses' counts the
+    // readers of each buffer, views' consumers included.
+    u64* bytes = SF_ARENA_PUSH(arena, u64, count);
+    u32* owner = SF_ARENA_PUSH(arena, u32, count);
+    u32* uses = SF_ARENA_PUSH(arena, u32, count);
+    u32* remaining = SF_ARENA_PUSH(arena, u32, count);
+    memset(uses, 0, sizeof(u32) * count);
+    for (u32 p = 0; p < count; ++p) {
+        u32 src = sorted[p]->inputs[0].src_node_idx;
+        bool alias = is_view(sorted[p]) && src != UINT32_MAX && pos_of[src] != UINT32_MAX;
+        owner[p] = alias ? owner[pos_of[src]] : p;
+        bytes[p] = node_bytes(sorted[p]);
+        for (u32 k = 0; k < 4; ++k) {
+            u32 o = input_owner(sorted, pos_of, owner, p, k);
+            if (o != UINT32_MAX) uses[o]++;
+        }
+    }
+    memcpy(remaining, uses, sizeof(u32) * count);
+    bool min_memory = ctx->options && ctx->options->schedule == SF_SCHEDULE_MIN_MEMORY;
+
+    // 3. List scheduling. Cluster mode keeps a heap per bucket plus one over every ready
+    // instruction ('any', scheduled entries are skipped lazily); min-memory mode scans a
+    // plain ready list that only holds unscheduled instructions.
+    sf_pos_heap* ready = SF_ARENA_PUSH(arena, sf_pos_heap, bucket_count ? bucket_count : 1);
+    memset(ready, 0, sizeof(sf_pos_heap) * (bucket_count ? bucket_count : 1));
+    sf_pos_heap any = {0};
+    sf_pos_heap free_nodes = {0};
+    u32* ready_list = SF_ARENA_PUSH(arena, u32, count);
+    u32 ready_count = 0;
+    u8* done = SF_ARENA_PUSH(arena, u8, count);
+    memset(done, 0, count);
+
+    for (u32 p = 0; p < count; ++p) {
+        if (indegree[p] != 0) continue;
+        if (bucket[p] == UINT32_MAX) heap_push(&free_nodes, arena, p);
+        else if (min_memory) ready_list[ready_count++] = p;
+        else { heap_push(&ready[bucket[p]], arena, p); heap_push(&any, arena, p); }
+    }
+
+    sf_ir_node** order = SF_ARENA_PUSH(arena, sf_ir_node*, count);
+    u32 emitted = 0;
+    u32 current = UINT32_MAX;
+    while (emitted < count) {
+        u32 p = UINT32_MAX;
+        if (free_nodes.count) {
+            p = heap_pop(&free_nodes);
+        } else if (min_memory) {
+            if (!ready_count) break;
+            // Linear in the ready set, which stays narrow for typical kernels
+            i64 best_delta = 0;
+            u32 best = 0;
+            for (u32 i = 0; i < ready_count; ++i) {
+                u32 q = ready_list[i];
+                i64 delta = schedule_delta(sorted, pos_of, owner, remaining, bytes, q);
+                if (p == UINT32_MAX || delta < best_delta || (delta == best_delta && q < p)) { p = q; best = i; best_delta = delta; }
+            }
+            ready_list[best] = ready_list[--ready_count];
+        } else {
+            while (any.count && done[any.items[0]]) heap_pop(&any);
+            if (!any.count) break;
+            if (current == UINT32_MAX || ready[current].count == 0) current = bucket[any.items[0]];
+            p = heap_pop(&ready[current]);
+        }
+
+        done[p] = 1;
+        order[emitted++] = sorted[p];
+        retire_inputs(sorted, pos_of, owner, remaining, bytes, p);
+        for (u32 s = succ_start[p]; s < succ_start[p + 1]; ++s) {
+            u32 q = succ[s];
+            if (--indegree[q] != 0) continue;
+            if (bucket[q] == UINT32_MAX) heap_push(&free_nodes, arena, q);
+            else if (min_memory) ready_list[ready_count++] = q;
+            else { heap_push(&ready[bucket[q]], arena, q); heap_push(&any, arena, q); }
+        }
+    }
+
+    if (emitted != count) {
+        SF_REPORT(diag, NULL, "Scheduling Error: Dependency graph is not acyclic");
+        return false;
+    }
+
+    memcpy(sorted, order, sizeof(sf_ir_node*) * count);
+    ctx->peak_live_bytes = measure_peak(sorted, count, ir, pos_of, owner, uses, bytes, arena);
+    SF_LOG_INFO("Scheduling (%s): %u nodes in %u domain/strategy buckets, peak %llu live bytes",
+        min_memory ? "min-memory" : "cluster", count, bucket_count, (unsigned long long)ctx->peak_live_bytes);
+    return true;
+}
@@ -9,6 +9,10 @@
  * Task Planning Pass
  * Groups instructions into execution tasks, plans barriers, and bakes strides for broadcasting.
  * This logic was extracted from codegen to keep the compiler modular and elegant.
+ *
+ * Default-strategy tasks are tiled so one tile's working set (all bindings) fits the L1 budget
+ * from the compiler options; other strategies keep one tile per innermost row. Rows are only
+ * split when every instruction of the task is elementwise (ELEMENTWISE trait, domain shape).
  */
 
 static void calculate_grid(sf_grid* grid, const sf_type_info* domain) {
@@ -32,6 +36,52 @@ static void calculate_grid(sf_grid* grid, const sf_type_info* domain) {
     }
 }
 
+static bool same_shape(const sf_type_info* a, const sf_type_info* b) {
+    return a->ndim == b->ndim && memcmp(a->shape, b->shape, sizeof(a->shape[0]) * a->ndim) == 0;
+}
+
+// Largest divisor of 'extent' that is not above 'limit' (at least 1), so tiles cover the domain exactly
+static u32 largest_divisor(u32 extent, u64 limit) {
+    if (limit >= extent) return extent;
+    u32 best = 1;
+    for (u32 i = 1; (u64)i * i <= extent; ++i) {
+        if (extent % i != 0) continue;
+        if (i <= limit && i > best) best = i;
+        if (extent / i <= limit && extent / i > best) best = extent / i;
+    }
+    return best;
+}
+
+// Grows the tile from the innermost dimension outwards until 'elem_bytes' per element
+// (summed over the task's bindings) would exceed the L1 budget. Without 'split_rows' the
+// innermost dimension always stays whole.
+static void plan_tiles(sf_grid* grid, const sf_type_info* domain, u64 elem_bytes, u64 l1_bytes, u64 l2_bytes, bool split_rows) {
+    memset(grid, 0, sizeof(sf_grid));
+    u64 budget = elem_bytes ? l1_bytes / elem_bytes : l1_bytes;
+    if (budget == 0) budget = 1;
+
+    u64 tile_elems = 1;
+    bool growing = true;
+    grid->total_tiles = 1;
+    for (int d = domain->ndim - 1; d >= 0; --d) {
+        u32 extent = (u32)domain->shape[d];
+        u32 tile = 1;
+        if (growing) {
+            u64 allowed = budget / tile_elems;
+            tile = largest_divisor(extent, allowed);
+            // Rows that fit L2 stay whole for long contiguous runs. Longer ones are only split when
+            // the length has a divisor near the budget, otherwise (e.g. prime lengths) they stay whole too.
+            if (d == domain->ndim - 1 && tile < extent &&
+                (!split_rows || (u64)extent * elem_bytes <= l2_bytes || (u64)tile * 2 <= allowed)) tile = extent;
+            growing = (tile == extent);
+        }
+        grid->tile_shape[d] = tile;
+        grid->dims[d] = extent / tile;
+        grid->total_tiles *= grid->dims[d];
+        tile_elems *= tile;
+    }
+}
+
 bool sf_pass_task_plan(sf_pass_ctx* ctx, sf_compiler_diag* diag) {
     sf_graph_ir* ir = ctx->ir;
     sf_arena* arena = ctx->arena;
@@ -41,6 +91,8 @@ bool sf_pass_task_plan(sf_pass_ctx* ctx, sf_compiler_diag* diag) {
     // Allocate Task and Binding buffers
     sf_task* tasks = SF_ARENA_PUSH(arena, sf_task, count);
     sf_bin_task_binding* bindings = SF_ARENA_PUSH(arena, sf_bin_task_binding, count * 5);
+    u8* whole_rows = SF_ARENA_PUSH(arena, u8, count ? count : 1); // Task has a non-elementwise instruction
+    memset(whole_rows, 0, count ? count : 1);
     u32 task_count = 0;
     u32 binding_count = 0;
     u32 instr_idx = 0;
@@ -48,6 +100,26 @@ bool sf_pass_task_plan(sf_pass_ctx* ctx, sf_compiler_diag* diag) {
     u32 current_domain_idx = UINT32_MAX;
     u8 current_strategy = SF_STRATEGY_DEFAULT;
     uint8_t modified_regs[SF_MAX_REGISTERS / 8] = {0};
+    uint8_t read_regs[SF_MAX_REGISTERS / 8] = {0};
+    uint8_t cross_read_regs[SF_MAX_REGISTERS / 8] = {0}; // Read by ops that touch other elements
+    uint8_t cross_write_regs[SF_MAX_REGISTERS / 8] = {0}; // Written by ops whose element i is not the domain's element i
+    const sf_type_info* current_domain = NULL;
+
+    // Register -> first node holding it (what find_node_by_reg returns), built in one sweep
+    u32 reg_count = 1;
+    for (size_t i = 0; i < ir->node_count; ++i) {
+        if (ir->nodes[i].type != SF_NODE_UNKNOWN && (u32)ir->nodes[i].out_reg_idx + 1 > reg_count) reg_count = (u32)ir->nodes[i].out_reg_idx + 1;
+    }
+    u32* node_of_reg = SF_ARENA_PUSH(arena, u32, reg_count);
+    for (u32 r = 0; r < reg_count; ++r) node_of_reg[r] = UINT32_MAX;
+    for (size_t i = ir->node_count; i-- > 0;) {
+        if (ir->nodes[i].type != SF_NODE_UNKNOWN) node_of_reg[ir->nodes[i].out_reg_idx] = (u32)i;
+    }
+
+    // Binding dedup: binding_slot[r] is valid while binding_task[r] names the current task
+    u32* binding_slot = SF_ARENA_PUSH(arena, u32, reg_count);
+    u32* binding_task = SF_ARENA_PUSH(arena, u32, reg_count);
+    memset(binding_task, 0, sizeof(u32) * reg_count);
 
     for (size_t i = 0; i < count; ++i) {
         sf_ir_node* node = sorted[i];
@@ -81,30 +153,61 @@ bool sf_pass_task_plan(sf_pass_ctx* ctx, sf_compiler_diag* diag) {
             
             current_domain_idx = node->domain_node_idx;
             current_strategy = meta->strategy;
-            calculate_grid(&t->grid, &ir->nodes[dom_idx].out_info);
+            current_domain = &ir->nodes[dom_idx].out_info;
+            calculate_grid(&t->grid, current_domain);
             memset(modified_regs, 0, sizeof(modified_regs));
+            memset(read_regs, 0, sizeof(read_regs));
+            memset(cross_read_regs, 0, sizeof(cross_read_regs));
+            memset(cross_write_regs, 0, sizeof(cross_write_regs));
         }
 
         sf_task* curr_task = &tasks[task_count - 1];
 
+        // Access pattern: an elementwise op over the task's domain reads and writes element i
+        // only while processing element i, so it cannot race with other tiles over the same data.
+        // Only ops on the ELEMENTWISE allowlist qualify; everything else (memory ops, reducers,
+        // row-wise ops, non-default strategies) and broadcast reads touch other elements.
+        bool elementwise = (SF_COMPILER_NODE_TRAITS[node->type] & SF_NODE_TRAIT_ELEMENTWISE) &&
+            meta->strategy == SF_STRATEGY_DEFAULT && same_shape(&node->out_info, current_domain);
+        if (!elementwise) whole_rows[task_count - 1] = 1;
+
         // Resource Binding & Barrier Planning
         u16 regs[5] = { out_reg, 0, 0, 0, 0 };
+        bool broadcast_read[5] = { false, false, false, false, false };
         for (u32 k = 0; k < 4; ++k) {
             if (meta->ports[k]) {
                 sf_ir_node* src = find_input_source(ir, node_idx, k);
-                if (src) regs[k+1] = src->out_reg_idx;
+                if (src) {
+                    regs[k+1] = src->out_reg_idx;
+                    broadcast_read[k+1] = !same_shape(&src->out_info, &node->out_info);
+                }
             }
         }
 
-        // Add Barrier if we read something that was modified in the SAME task
-        for (int k = 1; k < 5; ++k) {
+        // Add Barrier only for real cross-element dependencies inside the SAME task:
+        // - RAW: reading a register modified earlier, unless both the write and the read are elementwise.
+        // - WAR: overwriting a register an earlier instruction still reads. Elementwise readers
+        //   finish each index before an elementwise writer rewrites it (in place or reused).
+        const uint8_t* war_regs = elementwise ? cross_read_regs : read_regs;
+        bool hazard = (war_regs[out_reg / 8] & (1 << (out_reg % 8))) != 0;
+        for (int k = 1; k < 5 && !hazard; ++k) {
             u16 r = regs[k];
-            if (r > 0 && (modified_regs[r / 8] & (1 << (r % 8)))) {
-                curr_task->flags |= SF_TASK_FLAG_BARRIER;
-                memset(modified_regs, 0, sizeof(modified_regs));
-                break;
-            }
+            if (r == 0 || !(modified_regs[r / 8] & (1 << (r % 8)))) continue;
+            bool cross_read = !elementwise || broadcast_read[k];
+            if (cross_read || (cross_write_regs[r / 8] & (1 << (r % 8)))) hazard = true;
+        }
+        if (hazard) {
+            curr_task->flags |= SF_TASK_FLAG_BARRIER;
+            memset(modified_regs, 0, sizeof(modified_regs));
+            memset(read_regs, 0, sizeof(read_regs));
+            memset(cross_read_regs, 0, sizeof(cross_read_regs));
+            memset(cross_write_regs, 0, sizeof(cross_write_regs));
         }
+        for (int k = 1; k < 5; ++k) {
+            if (regs[k] > 0) read_regs[regs[k] / 8] |= (1 << (regs[k] % 8));
+            if (regs[k] > 0 && (!elementwise || broadcast_read[k])) cross_read_regs[regs[k] / 8] |= (1 << (regs[k] % 8));
+        }
+        if (!elementwise) cross_write_regs[out_reg / 8] |= (1 << (out_reg % 8));
 
         // Update bindings
         for (int k = 0; k < 5; ++k) {
@@ -113,18 +216,15 @@ bool sf_pass_task_plan(sf_pass_ctx* ctx, sf_compiler_diag* diag) {
             
             if (k == 0) modified_regs[r / 8] |= (1 << (r % 8));
             
-            bool found = false;
             u16 b_flags = (k == 0) ? SF_BINDING_FLAG_WRITE : SF_BINDING_FLAG_READ;
             if (meta->strategy == SF_STRATEGY_REDUCTION && k == 0) b_flags |= SF_BINDING_FLAG_REDUCTION;
 
-            for (u32 b = 0; b < curr_task->binding_count; ++b) {
-                if (bindings[curr_task->binding_offset + b].reg_idx == r) {
-                    bindings[curr_task->binding_offset + b].flags |= b_flags;
-                    found = true; break;
-                }
-            }
-            if (!found) {
-                sf_bin_task_binding* b = &bindings[curr_task->binding_offset + curr_task->binding_count++];
+            if (binding_task[r] == task_count) {
+                bindings[binding_slot[r]].flags |= b_flags;
+            } else {
+                binding_task[r] = task_count; // Task ids stamped here start at 1
+                binding_slot[r] = curr_task->binding_offset + curr_task->binding_count++;
+                sf_bin_task_binding* b = &bindings[binding_slot[r]];
                 b->reg_idx = r;
                 b->flags = b_flags;
                 binding_count++;
@@ -138,18 +238,28 @@ bool sf_pass_task_plan(sf_pass_ctx* ctx, sf_compiler_diag* diag) {
         tasks[task_count - 1].inst_count = instr_idx - tasks[task_count - 1].start_inst;
     }
 
-    // Phase 2: Stride Baking (Broadcasting logic)
+    // Phase 2: Stride Baking (Broadcasting logic) and tiling
+    u64 l1_bytes = ctx->options && ctx->options->l1_cache_bytes ? ctx->options->l1_cache_bytes : SF_DEFAULT_L1_CACHE_BYTES;
+    u64 l2_bytes = ctx->options && ctx->options->l2_cache_bytes ? ctx->options->l2_cache_bytes : SF_DEFAULT_L2_CACHE_BYTES;
     for (u32 t_idx = 0; t_idx < task_count; ++t_idx) {
         sf_task* t = &tasks[t_idx];
-        sf_type_info* dom_info = &ir->nodes[find_node_by_reg(ir, t->domain_reg)].out_info;
+        sf_type_info* dom_info = &ir->nodes[node_of_reg[t->domain_reg]].out_info;
+        u64 elem_bytes = 0;
         
         for (u32 b_idx = 0; b_idx < t->binding_count; ++b_idx) {
             sf_bin_task_binding* b = &bindings[t->binding_offset + b_idx];
-            sf_type_info* reg_info = &ir->nodes[find_node_by_reg(ir, b->reg_idx)].out_info;
+            sf_type_info* reg_info = &ir->nodes[node_of_reg[b->reg_idx]].out_info;
             
             sf_shape_get_broadcast_strides(reg_info, dom_info, b->strides);
             i32 dtype_sz = (i32)sf_dtype_size(reg_info->dtype);
             for (int d = 0; d < SF_MAX_DIMS; ++d) b->strides[d] *= (dtype_sz ? dtype_sz : 4);
+            elem_bytes += (u64)(dtype_sz ? dtype_sz : 4); // Broadcast operands are counted in full
+        }
+
+        bool is_static = dom_info->ndim > 0;
+        for (u8 d = 0; d < dom_info->ndim; ++d) if (dom_info->shape[d] <= 0) is_static = false;
+        if (t->strategy == SF_STRATEGY_DEFAULT && is_static) {
+            plan_tiles(&t->grid, dom_info, elem_bytes, l1_bytes, l2_bytes, !whole_rows[t_idx]);
         }
     }
 
@@ -20,7 +20,7 @@ void sf_compiler_diag_report(sf_compiler_diag* diag, sf_source_loc loc, const ch
     diag->has_error = true;
     if (diag->error_count >= diag->error_capacity) {
         if (diag->error_count == diag->error_capacity) {
-            SF_LOG_ERROR("Error capacity reached, suppressing further errors.");
+            if (!diag->muted) SF_LOG_ERROR("Error capacity reached, suppressing further errors.");
             diag->error_count++;
         }
         return;
@@ -35,6 +35,7 @@ void sf_compiler_diag_report(sf_compiler_diag* diag, sf_source_loc loc, const ch
     va_end(args);
 
     // Also log to console for immediate feedback during development
+    if (diag->muted) return;
     const char* file = loc.file ? loc.file : "unknown";
     if (loc.line > 0) {
         SF_LOG_ERROR("%s:%u:%u: error: %s", file, loc.line, loc.column, err->message);
@@ -51,10 +52,23 @@ extern const size_t SF_COMPILER_PIPELINE_COUNT;
 
 // --- Compilation ---
 
-sf_program* sf_compile(sf_graph_ir* ir, sf_arena* arena, sf_compiler_diag* diag) {
+void sf_compiler_options_init(sf_compiler_options* opts) {
+    memset(opts, 0, sizeof(sf_compiler_options));
+    opts->tensor_alignment = SF_DEFAULT_TENSOR_ALIGNMENT;
+    opts->l1_cache_bytes = SF_DEFAULT_L1_CACHE_BYTES;
+    opts->l2_cache_bytes = SF_DEFAULT_L2_CACHE_BYTES;
+    opts->fold_max_bytes = SF_DEFAULT_FOLD_MAX_BYTES;
+}
+
+bool sf_compile_ex(sf_graph_ir* ir, const sf_compiler_options* opts, sf_arena* arena, sf_compiler_diag* diag, sf_compile_result* out) {
+    sf_compiler_options defaults;
+    sf_compiler_options_init(&defaults);
+    memset(out, 0, sizeof(sf_compile_result));
+
     sf_pass_ctx ctx = {0};
     ctx.ir = ir;
     ctx.arena = arena;
+    ctx.options = opts ? opts : &defaults;
 
     // Execute Declarative Pipeline
     for (size_t i = 0; i < SF_COMPILER_PIPELINE_COUNT; ++i) {
@@ -63,7 +77,7 @@ sf_program* sf_compile(sf_graph_ir* ir, sf_arena* arena, sf_compiler_diag* diag)
         
         if (!pass->func(&ctx, diag) || (diag && diag->has_error)) {
             SF_LOG_ERROR("Pass '%s' failed", pass->name);
-            return NULL;
+            return false;
         }
     }
 
@@ -75,10 +89,40 @@ sf_program* sf_compile(sf_graph_ir* ir, sf_arena* arena, sf_compiler_diag* diag)
     if (!sf_codegen_emit(prog, &ctx, arena)) {
         sf_source_loc loc = {0};
         sf_compiler_diag_report(diag, loc, "Code generation failed.");
-        return NULL;
+        return false;
     }
-    
-    return prog;
+
+    out->program = prog;
+    out->memory = ctx.memory;
+    out->peak_live_bytes = ctx.peak_live_bytes;
+    return true;
+}
+
+sf_program* sf_compile(sf_graph_ir* ir, sf_arena* arena, sf_compiler_diag* diag) {
+    sf_compile_result result;
+    return sf_compile_ex(ir, NULL, arena, diag, &result) ? result.program : NULL;
+}
+
+#define SF_MEMORY_PLAN_MAGIC 0x504D4653u // "SFMP"
+#define SF_MEMORY_PLAN_VERSION 1
+
+typedef struct {
+    u32 magic;
+    u32 version;
+    u64 arena_size;
+    u32 alignment;
+    u32 tensor_count;
+} sf_memory_plan_header;
+
+void* sf_memory_plan_serialize(const sf_memory_plan* plan, sf_arena* arena, u32* out_size) {
+    sf_memory_plan_header header = { SF_MEMORY_PLAN_MAGIC, SF_MEMORY_PLAN_VERSION, plan->arena_size, plan->alignment, plan->tensor_count };
+    size_t offsets_size = sizeof(u64) * plan->tensor_count;
+    u8* blob = SF_ARENA_PUSH(arena, u8, sizeof(header) + offsets_size);
+    if (!blob) return NULL;
+    memcpy(blob, &header, sizeof(header));
+    if (offsets_size) memcpy(blob + sizeof(header), plan->offsets, offsets_size);
+    *out_size = (u32)(sizeof(header) + offsets_size);
+    return blob;
 }
 
 bool sf_compile_save_program(const sf_program* prog, const char* path) {
@@ -87,6 +131,19 @@ bool sf_compile_save_program(const sf_program* prog, const char* path) {
 }
 
 bool sf_compile_save_cartridge(const char* path, const sf_graph_ir* ir, const sf_section_desc* sections, u32 section_count) {
+    return sf_compile_save_cartridge_ex(path, ir, sections, section_count, false, NULL, NULL);
+}
+
+bool sf_compile_save_cartridge_ex(const char* path, const sf_graph_ir* ir, const sf_section_desc* sections, u32 section_count, bool share_constants, sf_arena* arena, sf_const_pool_stats* out_stats) {
+    sf_const_pool_stats stats;
+    memset(&stats, 0, sizeof(stats));
+    if (share_constants) {
+        sf_section_desc* shared = NULL;
+        if (!arena || !sf_const_pool_share(sections, section_count, arena, &shared, &section_count, &stats)) return false;
+        sections = shared;
+    }
+    if (out_stats) *out_stats = stats;
+
     sf_cartridge_params params = {0};
     if (ir) {
         strncpy(params.app_title, ir->app_title, SF_MAX_TITLE_NAME - 1);
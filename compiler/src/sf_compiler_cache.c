@@ -0,0 +1,371 @@
+#include <sionflow/compiler/sf_compiler.h>
+#include "sf_passes.h"
+#include "sf_compiler_internal.h"
+#include <sionflow/base/sf_json.h>
+#include <sionflow/base/sf_utils.h>
+#include <sionflow/base/sf_log.h>
+#include <sionflow/base/sf_shape.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <process.h>
+#define sf_cache_getpid() _getpid()
+#else
+#include <unistd.h>
+#define sf_cache_getpid() getpid()
+#endif
+
+/**
+ * Compilation Cache
+ * Stores compiled kernels on disk, addressed by a hash of everything that can change
+ * the generated program: the kernel source, its transitive imports and constant payloads,
+ * the compiler options, the compiler spec, the pass pipeline, the ISA metadata/layout and a
+ * build ID hashing the compiler sources linked into this binary.
+ */
+
+#define SF_CACHE_MAGIC 0x4B434653u // "SFCK"
+#define SF_CACHE_VERSION 12 // Bump when the entry layout changes; pass changes are covered by the build ID
+
+// Generated from compiler_spec.json
+extern const char SF_COMPILER_SPEC_JSON[];
+// Generated at build time: hash of the compiler sources, generated code and C toolchain
+extern const char SF_COMPILER_BUILD_ID[];
+extern const sf_pipeline_pass_def SF_COMPILER_PIPELINE[];
+extern const size_t SF_COMPILER_PIPELINE_COUNT;
+
+typedef struct {
+    u32 magic;
+    u32 version;
+    u64 key;
+    sf_bin_header meta;
+    char app_title[SF_MAX_TITLE_NAME];
+    u32 window_width;
+    u32 window_height;
+    u32 num_threads;
+    u8 vsync;
+    u8 fullscreen;
+    u8 resizable;
+} sf_cache_header;
+
+// --- Key Computation ---
+
+typedef struct {
+    const char** paths;
+    u32 count;
+    u32 cap;
+} sf_cache_visit_set;
+
+static u64 hash_toolchain(u64 h) {
+    u32 version = SF_CACHE_VERSION;
+    h = sf_hash64(&version, sizeof(version), h);
+    h = sf_hash64_str(SF_COMPILER_BUILD_ID, h);
+    h = sf_hash64_str(SF_COMPILER_SPEC_JSON, h);
+
+    for (size_t i = 0; i < SF_COMPILER_PIPELINE_COUNT; ++i) {
+        h = sf_hash64_str(SF_COMPILER_PIPELINE[i].id, h);
+    }
+
+    for (int i = 0; i < SF_NODE_COUNT; ++i) {
+        const sf_op_metadata* meta = &SF_OP_METADATA[i];
+        h = sf_hash64_str(meta->name, h);
+        h = sf_hash64(&meta->opcode, sizeof(meta->opcode), h);
+        h = sf_hash64(&meta->category, sizeof(meta->category), h);
+        h = sf_hash64(&meta->strategy, sizeof(meta->strategy), h);
+        h = sf_hash64(&meta->out_rule, sizeof(meta->out_rule), h);
+        h = sf_hash64(&meta->flags, sizeof(meta->flags), h);
+        for (int p = 0; p < 4; ++p) h = sf_hash64_str(meta->ports[p], h);
+    }
+
+    // Binary layout of everything we serialize
+    const u32 layout[] = {
+        (u32)sizeof(sf_bin_header), (u32)sizeof(sf_bin_symbol), (u32)sizeof(sf_type_info),
+        (u32)sizeof(sf_instruction), (u32)sizeof(sf_task), (u32)sizeof(sf_bin_task_binding),
+        (u32)SF_NODE_COUNT
+    };
+    return sf_hash64(layout, sizeof(layout), h);
+}
+
+static u64 hash_options(const sf_compiler_options* opts, u64 h) {
+    sf_compiler_options defaults;
+    if (!opts) { sf_compiler_options_init(&defaults); opts = &defaults; }
+    // Field by field: struct padding is not part of the key
+    u32 schedule = (u32)opts->schedule;
+    h = sf_hash64(&opts->tensor_alignment, sizeof(opts->tensor_alignment), h);
+    h = sf_hash64(&schedule, sizeof(schedule), h);
+    h = sf_hash64(&opts->l1_cache_bytes, sizeof(opts->l1_cache_bytes), h);
+    h = sf_hash64(&opts->l2_cache_bytes, sizeof(opts->l2_cache_bytes), h);
+    h = sf_hash64(&opts->fold_max_bytes, sizeof(opts->fold_max_bytes), h);
+    u8 strict_fp = opts->strict_fp ? 1 : 0;
+    return sf_hash64(&strict_fp, sizeof(strict_fp), h);
+}
+
+static const char* resolve_ref(const char* base_path, const char* ref, sf_arena* arena) {
+    if (sf_path_is_absolute(ref)) return ref;
+    char* dir = sf_path_get_dir(base_path, arena);
+    const char* path = sf_path_join(dir, ref, arena);
+    // Same fallback as the loader: paths relative to the working directory
+    if (!sf_file_exists(path) && sf_file_exists(ref)) return ref;
+    return path;
+}
+
+static bool hash_source(const char* path, sf_arena* arena, sf_cache_visit_set* seen, u64* h);
+
+static bool hash_node_refs(const char* base_path, const sf_json_value* data, sf_arena* arena, sf_cache_visit_set* seen, u64* h) {
+    if (!data || data->type != SF_JSON_VAL_OBJECT) return true;
+    const sf_json_value* path = sf_json_get_field(data, "path");
+    if (path && path->type == SF_JSON_VAL_STRING) {
+        if (!hash_source(resolve_ref(base_path, path->as.s, arena), arena, seen, h)) return false;
+    }
+    // External constant payloads are part of the graph: their bytes go into the key
+    const sf_json_value* value = sf_json_get_field(data, "value");
+    const sf_json_value* payload = value ? sf_json_get_field(value, "path") : NULL;
+    if (payload && payload->type == SF_JSON_VAL_STRING) {
+        size_t size = 0;
+        void* bytes = sf_file_read_bin(resolve_ref(base_path, payload->as.s, arena), &size);
+        if (!bytes) return false;
+        *h = sf_hash64(&size, sizeof(size), *h);
+        *h = sf_hash64(bytes, size, *h);
+        free(bytes);
+    }
+    return hash_node_refs(base_path, sf_json_get_field(data, "meta"), arena, seen, h);
+}
+
+// Binary IR: the file bytes, then the graphs its CALL nodes graft (paths already resolved)
+static bool hash_binary_ir(const char* path, sf_arena* arena, sf_cache_visit_set* seen, u64* h) {
+    size_t size = 0;
+    void* data = sf_file_read_bin(path, &size);
+    if (!data) return false;
+    *h = sf_hash64(data, size, *h);
+    free(data);
+
+    sf_graph_ir ir;
+    sf_compiler_diag diag;
+    sf_compiler_diag_init(&diag, arena);
+    if (!sf_compile_load_ir(path, &ir, arena, &diag)) return false;
+    for (size_t i = 0; i < ir.node_count; ++i) {
+        const char* sub = ir.nodes[i].sub_graph_path;
+        if (ir.nodes[i].type == SF_NODE_CALL && sub && !hash_source(sub, arena, seen, h)) return false;
+    }
+    return true;
+}
+
+static bool hash_source(const char* path, sf_arena* arena, sf_cache_visit_set* seen, u64* h) {
+    // Each file contributes once; repeated imports only record their position
+    for (u32 i = 0; i < seen->count; ++i) {
+        if (strcmp(seen->paths[i], path) == 0) {
+            *h = sf_hash64(&i, sizeof(i), *h);
+            return true;
+        }
+    }
+    if (seen->count == seen->cap) {
+        u32 new_cap = seen->cap ? seen->cap * 2 : 16;
+        const char** paths = SF_ARENA_PUSH(arena, const char*, new_cap);
+        if (seen->count) memcpy(paths, seen->paths, sizeof(const char*) * seen->count);
+        seen->paths = paths;
+        seen->cap = new_cap;
+    }
+    seen->paths[seen->count++] = path;
+
+    if (strcmp(sf_path_get_ext(path), "sfir") == 0) return hash_binary_ir(path, arena, seen, h);
+
+    char* content = sf_file_read(path, arena);
+    if (!content) return false;
+    *h = sf_hash64(content, strlen(content), *h);
+
+    sf_ast_graph* ast = sf_json_parse_graph(content, arena);
+    if (!ast) return false;
+
+    for (size_t i = 0; i < ast->import_count; ++i) {
+        if (!hash_source(resolve_ref(path, ast->imports[i], arena), arena, seen, h)) return false;
+    }
+    for (size_t i = 0; i < ast->node_count; ++i) {
+        if (!hash_node_refs(path, ast->nodes[i].data, arena, seen, h)) return false;
+    }
+    return true;
+}
+
+bool sf_compile_cache_key(const char* json_path, const sf_compiler_options* opts, sf_arena* arena, u64* out_key) {
+    if (!json_path || !out_key) return false;
+    sf_cache_visit_set seen = {0};
+    u64 h = hash_options(opts, hash_toolchain(SF_HASH64_SEED));
+    if (!hash_source(json_path, arena, &seen, &h)) return false;
+    *out_key = h;
+    return true;
+}
+
+// --- Serialization ---
+
+static size_t const_data_size(const sf_type_info* info) {
+    size_t count = sf_shape_calc_count(info->shape, info->ndim);
+    if (count == 0) count = 1;
+    return count * sf_dtype_size(info->dtype);
+}
+
+static void cache_entry_path(char* out, size_t out_size, const char* cache_dir, u64 key) {
+    snprintf(out, out_size, "%s/%016llx.sfk", cache_dir, (unsigned long long)key);
+}
+
+static bool write_block(FILE* f, const void* data, size_t size) {
+    return size == 0 || fwrite(data, 1, size, f) == size;
+}
+
+bool sf_compile_cache_store(const char* cache_dir, u64 key, const sf_compile_result* result, const sf_graph_ir* settings) {
+    if (!cache_dir || !result || !result->program) return false;
+    const sf_program* prog = result->program;
+    const sf_memory_plan* plan = &result->memory;
+
+    char path[1024], tmp_path[1100];
+    cache_entry_path(path, sizeof(path), cache_dir, key);
+    // Unique temporary name so concurrent writers never interleave; rename publishes atomically.
+    // The pid separates processes, the program address separates threads within one.
+    snprintf(tmp_path, sizeof(tmp_path), "%s.%ld.%p.tmp", path, (long)sf_cache_getpid(), (const void*)prog);
+
+    sf_cache_header header;
+    memset(&header, 0, sizeof(header));
+    header.magic = SF_CACHE_MAGIC;
+    header.version = SF_CACHE_VERSION;
+    header.key = key;
+    header.meta = prog->meta;
+    if (settings) {
+        strncpy(header.app_title, settings->app_title, SF_MAX_TITLE_NAME - 1);
+        header.window_width = settings->window_width;
+        header.window_height = settings->window_height;
+        header.num_threads = settings->num_threads;
+        header.vsync = settings->vsync;
+        header.fullscreen = settings->fullscreen;
+        header.resizable = settings->resizable;
+    }
+
+    FILE* f = fopen(tmp_path, "wb");
+    if (!f) return false;
+
+    const sf_bin_header* m = &prog->meta;
+    bool ok = write_block(f, &header, sizeof(header)) &&
+              write_block(f, prog->symbols, sizeof(sf_bin_symbol) * m->symbol_count) &&
+              write_block(f, prog->tensor_infos, sizeof(sf_type_info) * m->tensor_count) &&
+              write_block(f, prog->tensor_flags, sizeof(uint8_t) * m->tensor_count) &&
+              write_block(f, prog->code, sizeof(sf_instruction) * m->instruction_count) &&
+              write_block(f, prog->tasks, sizeof(sf_task) * m->task_count) &&
+              write_block(f, prog->bindings, sizeof(sf_bin_task_binding) * m->binding_count);
+
+    // Constant payloads, in register order
+    for (u32 i = 0; ok && i < m->tensor_count; ++i) {
+        if (!(prog->tensor_flags[i] & SF_TENSOR_FLAG_CONSTANT)) continue;
+        u64 size = prog->tensor_data[i] ? (u64)const_data_size(&prog->tensor_infos[i]) : 0;
+        ok = write_block(f, &size, sizeof(size)) && write_block(f, prog->tensor_data[i], (size_t)size);
+    }
+
+    // Memory plan
+    ok = ok && write_block(f, &result->peak_live_bytes, sizeof(result->peak_live_bytes)) &&
+         write_block(f, &plan->arena_size, sizeof(plan->arena_size)) &&
+         write_block(f, &plan->alignment, sizeof(plan->alignment)) &&
+         write_block(f, &plan->tensor_count, sizeof(plan->tensor_count)) &&
+         write_block(f, plan->offsets, sizeof(u64) * plan->tensor_count);
+
+    if (fclose(f) != 0) ok = false;
+    if (ok && rename(tmp_path, path) != 0) {
+        // Another writer may have published the same entry first
+        ok = false;
+    }
+    if (!ok) remove(tmp_path);
+    return ok;
+}
+
+typedef struct {
+    const u8* data;
+    size_t size;
+    size_t pos;
+} sf_cache_reader;
+
+static void* read_block(sf_cache_reader* r, size_t size, sf_arena* arena) {
+    if (r->size - r->pos < size) return NULL;
+    void* dst = sf_arena_alloc((sf_allocator*)arena, size ? size : 1);
+    if (size) memcpy(dst, r->data + r->pos, size);
+    r->pos += size;
+    return dst;
+}
+
+bool sf_compile_cache_load(const char* cache_dir, u64 key, sf_graph_ir* out_settings, sf_arena* arena, sf_compile_result* out) {
+    if (!cache_dir || !out) return false;
+
+    char path[1024];
+    cache_entry_path(path, sizeof(path), cache_dir, key);
+    if (!sf_file_exists(path)) return false;
+
+    size_t size = 0;
+    void* data = sf_file_read_bin(path, &size);
+    if (!data) return false;
+
+    sf_cache_reader r = { (const u8*)data, size, 0 };
+    sf_cache_header header;
+    sf_program* prog = NULL;
+
+    if (size < sizeof(header)) goto done;
+    memcpy(&header, data, sizeof(header));
+    r.pos = sizeof(header);
+    if (header.magic != SF_CACHE_MAGIC || header.version != SF_CACHE_VERSION || header.key != key) {
+        SF_LOG_DEBUG("Ignoring stale cache entry %s", path);
+        free(data);
+        return false;
+    }
+
+    const sf_bin_header* m = &header.meta;
+    sf_program* p = SF_ARENA_PUSH(arena, sf_program, 1);
+    memset(p, 0, sizeof(sf_program));
+    p->meta = *m;
+    p->symbols = m->symbol_count ? read_block(&r, sizeof(sf_bin_symbol) * m->symbol_count, arena) : NULL;
+    p->tensor_infos = read_block(&r, sizeof(sf_type_info) * m->tensor_count, arena);
+    p->tensor_flags = read_block(&r, sizeof(uint8_t) * m->tensor_count, arena);
+    p->code = read_block(&r, sizeof(sf_instruction) * m->instruction_count, arena);
+    p->tasks = read_block(&r, sizeof(sf_task) * m->task_count, arena);
+    p->bindings = read_block(&r, sizeof(sf_bin_task_binding) * m->binding_count, arena);
+    if ((m->symbol_count && !p->symbols) || !p->tensor_infos || !p->tensor_flags || !p->code || !p->tasks || !p->bindings) goto done;
+
+    p->tensor_data = SF_ARENA_PUSH(arena, void*, m->tensor_count);
+    memset(p->tensor_data, 0, sizeof(void*) * m->tensor_count);
+    for (u32 i = 0; i < m->tensor_count; ++i) {
+        if (!(p->tensor_flags[i] & SF_TENSOR_FLAG_CONSTANT)) continue;
+        u64 data_size = 0;
+        if (r.size - r.pos < sizeof(data_size)) goto done;
+        memcpy(&data_size, r.data + r.pos, sizeof(data_size));
+        r.pos += sizeof(data_size);
+        if (data_size == 0) continue;
+        if (data_size != const_data_size(&p->tensor_infos[i])) goto done;
+        p->tensor_data[i] = read_block(&r, (size_t)data_size, arena);
+        if (!p->tensor_data[i]) goto done;
+    }
+
+    sf_memory_plan plan = {0};
+    u64* peak_live_bytes = read_block(&r, sizeof(u64), arena);
+    u64* arena_size = read_block(&r, sizeof(u64), arena);
+    u32* alignment = read_block(&r, sizeof(u32), arena);
+    u32* plan_count = read_block(&r, sizeof(u32), arena);
+    if (!peak_live_bytes || !arena_size || !alignment || !plan_count || *plan_count != m->tensor_count) goto done;
+    plan.arena_size = *arena_size;
+    plan.alignment = *alignment;
+    plan.tensor_count = *plan_count;
+    plan.offsets = read_block(&r, sizeof(u64) * plan.tensor_count, arena);
+    if (!plan.offsets) goto done;
+
+    if (out_settings) {
+        memcpy(out_settings->app_title, header.app_title, SF_MAX_TITLE_NAME);
+        out_settings->app_title[SF_MAX_TITLE_NAME - 1] = '\0';
+        out_settings->window_width = header.window_width;
+        out_settings->window_height = header.window_height;
+        out_settings->num_threads = header.num_threads;
+        out_settings->vsync = header.vsync;
+        out_settings->fullscreen = header.fullscreen;
+        out_settings->resizable = header.resizable;
+    }
+    prog = p;
+    out->program = p;
+    out->memory = plan;
+    out->peak_live_bytes = *peak_live_bytes;
+
+done:
+    if (!prog) SF_LOG_INFO("Cache entry %s is corrupt, recompiling", path);
+    free(data);
+    return prog != NULL;
+}
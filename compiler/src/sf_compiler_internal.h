@@ -4,6 +4,7 @@
 #include <sionflow/compiler/sf_compiler.h>
 #include <sionflow/base/sf_utils.h>
 #include <sionflow/base/sf_json.h>
+#include <string.h>
 
 // Utilities
 sf_ir_node* find_input_source(sf_graph_ir* ir, u32 dst_node_idx, u32 dst_port);
@@ -11,9 +12,59 @@ sf_ir_node* sf_ir_find_input_by_name(sf_graph_ir* ir, u32 dst_node_idx, const ch
 sf_node_type sf_compiler_get_node_type(const char* type_str);
 u32 sf_compiler_get_port_index(sf_node_type type, const char* port_name);
 
+// External constant payloads: "value": { "path": ..., "dtype"?, "offset"? } (raw or .npy)
+bool sf_ir_load_const_payload(sf_ir_node* dst, const sf_json_value* ref, const char* base_path, sf_arena* arena, sf_compiler_diag* diag);
+
+// Rewrites the program sections to share duplicated constants (see sf_const_pool.c).
+// *out_sections is 'sections' itself when nothing is shared.
+bool sf_const_pool_share(const sf_section_desc* sections, u32 section_count, sf_arena* arena, sf_section_desc** out_sections, u32* out_count, sf_const_pool_stats* stats);
+
+// --- Node Traits ---
+// Generated from the 'flags' of compiler_spec.json node_constraints.
+typedef enum {
+    SF_NODE_TRAIT_COMMUTATIVE = 1 << 0,
+    SF_NODE_TRAIT_ASSOCIATIVE = 1 << 1,
+    SF_NODE_TRAIT_REDUCER     = 1 << 2,
+    SF_NODE_TRAIT_GENERATOR   = 1 << 3,
+    SF_NODE_TRAIT_SPATIAL     = 1 << 4,
+    SF_NODE_TRAIT_MEMORY      = 1 << 5, // Reads elements other than the one it writes
+    SF_NODE_TRAIT_INPLACE     = 1 << 6, // Output may overwrite an input of identical type and shape
+    SF_NODE_TRAIT_ELEMENTWISE = 1 << 7, // Output element i reads only element i of each input
+} sf_node_trait;
+
+extern const u32 SF_COMPILER_NODE_TRAITS[SF_NODE_COUNT];
+
+// 64-bit FNV-1a over a byte range. Chain calls by passing the previous result as 'h'.
+#define SF_HASH64_SEED 0xcbf29ce484222325ULL
+
+static inline u64 sf_hash64(const void* data, size_t size, u64 h) {
+    const u8* p = (const u8*)data;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= p[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+static inline u64 sf_hash64_str(const char* s, u64 h) {
+    return s ? sf_hash64(s, strlen(s) + 1, h) : sf_hash64("", 1, h);
+}
+
+// --- Read-only file mapping ---
+// Maps a whole non-empty file; 'data' stays valid until sf_file_map_close.
+typedef struct {
+    const u8* data;
+    size_t size;
+    void* file;    // Win32 file and mapping handles
+    void* mapping;
+} sf_file_map;
+
+bool sf_file_map_open(sf_file_map* map, const char* path);
+void sf_file_map_close(sf_file_map* map);
+
 // --- Internal: CodeGen ---
 // Emits instructions into the program
 typedef struct sf_pass_ctx sf_pass_ctx;
 bool sf_codegen_emit(sf_program* prog, sf_pass_ctx* ctx, sf_arena* arena);
 
-#endif // SF_COMPILER_INTERNAL_H
\ No newline at end of file
+#endif // SF_COMPILER_INTERNAL_H
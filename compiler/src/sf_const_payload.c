@@ -0,0 +1,297 @@
+#include "sf_compiler_internal.h"
+#include <sionflow/base/sf_utils.h>
+#include <sionflow/base/sf_log.h>
+#include <sionflow/base/sf_shape.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * External Constant Payloads
+ * A CONST 'value' may reference a binary file instead of inlining a number array:
+ *   "value": { "path": "lut.npy" }
+ *   "value": { "path": "weights.bin", "dtype": "f32", "offset": 0 }
+ * '.npy' files describe themselves (v1-v3 headers, C order, little endian). Anything else is
+ * raw native-order elements of the reference's 'dtype' (default: the node's). The file is
+ * mapped read-only and copied into the constant buffer with one memcpy, or with a single
+ * conversion loop when the file's element type differs from the node's dtype.
+ * A node without a declared shape or dtype takes them from the payload; declared ones must match.
+ */
+
+#define SF_NPY_MAGIC "\x93NUMPY"
+#define SF_NPY_MAGIC_SIZE 6
+
+// Element types a payload file may hold; converted to the node's dtype on load
+typedef enum {
+    SF_PAYLOAD_F32, SF_PAYLOAD_F64, SF_PAYLOAD_I8, SF_PAYLOAD_I16, SF_PAYLOAD_I32, SF_PAYLOAD_I64,
+    SF_PAYLOAD_U8, SF_PAYLOAD_U16, SF_PAYLOAD_U32, SF_PAYLOAD_COUNT
+} sf_payload_type;
+
+typedef struct {
+    const char* name; // Raw 'dtype' spelling
+    const char* npy;  // npy 'descr' without the byte order character
+    u32 size;
+    sf_dtype dtype;   // Matching IR dtype, UNKNOWN if it always needs conversion
+} sf_payload_type_info;
+
+static const sf_payload_type_info PAYLOAD_TYPES[SF_PAYLOAD_COUNT] = {
+    [SF_PAYLOAD_F32] = { "f32", "f4", 4, SF_DTYPE_F32 },
+    [SF_PAYLOAD_F64] = { "f64", "f8", 8, SF_DTYPE_UNKNOWN },
+    [SF_PAYLOAD_I8]  = { "i8",  "i1", 1, SF_DTYPE_UNKNOWN },
+    [SF_PAYLOAD_I16] = { "i16", "i2", 2, SF_DTYPE_UNKNOWN },
+    [SF_PAYLOAD_I32] = { "i32", "i4", 4, SF_DTYPE_I32 },
+    [SF_PAYLOAD_I64] = { "i64", "i8", 8, SF_DTYPE_UNKNOWN },
+    [SF_PAYLOAD_U8]  = { "u8",  "u1", 1, SF_DTYPE_U8 },
+    [SF_PAYLOAD_U16] = { "u16", "u2", 2, SF_DTYPE_UNKNOWN },
+    [SF_PAYLOAD_U32] = { "u32", "u4", 4, SF_DTYPE_UNKNOWN },
+};
+
+static int payload_type_from_name(const char* name) {
+    for (int i = 0; i < SF_PAYLOAD_COUNT; ++i) {
+        if (strcmp(PAYLOAD_TYPES[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+static int payload_type_from_dtype(sf_dtype dtype) {
+    for (int i = 0; i < SF_PAYLOAD_COUNT; ++i) {
+        if (PAYLOAD_TYPES[i].dtype == dtype && dtype != SF_DTYPE_UNKNOWN) return i;
+    }
+    return -1;
+}
+
+// --- .npy header ---
+
+typedef struct {
+    int type;
+    u8 ndim;
+    i32 shape[SF_MAX_DIMS];
+    size_t data_offset;
+} sf_npy_header;
+
+static const char* npy_field(const char* header, const char* key) {
+    const char* p = strstr(header, key);
+    if (!p) return NULL;
+    p = strchr(p + strlen(key), ':');
+    if (!p) return NULL;
+    p++;
+    while (*p == ' ') p++;
+    return p;
+}
+
+static bool host_is_little_endian(void) {
+    const u16 probe = 1;
+    return *(const u8*)&probe == 1;
+}
+
+// Parses the Python dict literal of a .npy header; the error text goes to *err
+static bool npy_parse_header(const u8* data, size_t size, sf_npy_header* out, sf_arena* arena, const char** err) {
+    *err = "malformed .npy header";
+    if (size < 10) return false;
+    u8 major = data[SF_NPY_MAGIC_SIZE];
+    size_t len_size = (major == 1) ? 2 : (major == 2 || major == 3) ? 4 : 0;
+    if (len_size == 0) { *err = "unsupported .npy version"; return false; }
+    if (size < 8 + len_size) return false;
+    size_t header_len = data[8] | ((size_t)data[9] << 8);
+    if (len_size == 4) header_len |= ((size_t)data[10] << 16) | ((size_t)data[11] << 24);
+    out->data_offset = 8 + len_size + header_len;
+    if (out->data_offset > size) return false;
+
+    char* header = SF_ARENA_PUSH(arena, char, header_len + 1);
+    memcpy(header, data + 8 + len_size, header_len);
+    header[header_len] = '\0';
+
+    // 'descr': '<f4'
+    const char* descr = npy_field(header, "'descr'");
+    if (!descr || *descr != '\'' || !descr[1] || !descr[2] || !descr[3] || descr[4] != '\'') return false;
+    char order = descr[1];
+    if (order == '>' || (order == '<' && !host_is_little_endian())) {
+        *err = "payload byte order does not match the host";
+        return false;
+    }
+    if (order != '<' && order != '|' && order != '=') return false;
+    out->type = -1;
+    for (int i = 0; i < SF_PAYLOAD_COUNT; ++i) {
+        if (strncmp(descr + 2, PAYLOAD_TYPES[i].npy, 2) == 0) { out->type = i; break; }
+    }
+    if (out->type < 0) { *err = "unsupported .npy element type"; return false; }
+
+    // 'fortran_order': False (column major only matters with more than one dimension)
+    const char* fortran = npy_field(header, "'fortran_order'");
+    if (!fortran) return false;
+    bool column_major = strncmp(fortran, "True", 4) == 0;
+
+    // 'shape': (2, 3), / (4,) / ()
+    const char* shape = npy_field(header, "'shape'");
+    if (!shape || *shape != '(') return false;
+    out->ndim = 0;
+    for (const char* p = shape + 1; *p != ')';) {
+        while (*p == ' ' || *p == ',') p++;
+        if (*p == ')') break;
+        char* end = NULL;
+        long dim = strtol(p, &end, 10);
+        if (end == p || dim < 0 || dim > INT32_MAX) return false;
+        if (out->ndim == SF_MAX_DIMS) { *err = "payload has too many dimensions"; return false; }
+        out->shape[out->ndim++] = (i32)dim;
+        p = end;
+    }
+    if (column_major && out->ndim > 1) { *err = "Fortran-ordered .npy payloads are not supported"; return false; }
+    return true;
+}
+
+// --- Conversion ---
+
+// One tight loop per source type; the compiler vectorizes these
+#define SF_CONVERT_LOOP(SRC_T, DST_T) \
+    do { const SRC_T* s = (const SRC_T*)src; DST_T* d = (DST_T*)dst; \
+         for (size_t i = 0; i < count; ++i) d[i] = (DST_T)s[i]; } while (0)
+
+#define SF_CONVERT_FROM(DST_T) \
+    switch (src_type) { \
+        case SF_PAYLOAD_F32: SF_CONVERT_LOOP(f32, DST_T); break; \
+        case SF_PAYLOAD_F64: SF_CONVERT_LOOP(f64, DST_T); break; \
+        case SF_PAYLOAD_I8:  SF_CONVERT_LOOP(int8_t, DST_T); break; \
+        case SF_PAYLOAD_I16: SF_CONVERT_LOOP(int16_t, DST_T); break; \
+        case SF_PAYLOAD_I32: SF_CONVERT_LOOP(i32, DST_T); break; \
+        case SF_PAYLOAD_I64: SF_CONVERT_LOOP(int64_t, DST_T); break; \
+        case SF_PAYLOAD_U8:  SF_CONVERT_LOOP(u8, DST_T); break; \
+        case SF_PAYLOAD_U16: SF_CONVERT_LOOP(uint16_t, DST_T); break; \
+        case SF_PAYLOAD_U32: SF_CONVERT_LOOP(u32, DST_T); break; \
+        default: return false; \
+    }
+
+// 'src' must be aligned for its element type
+static bool convert_payload(void* dst, sf_dtype dtype, const void* src, int src_type, size_t count) {
+    switch (dtype) {
+        case SF_DTYPE_F32: SF_CONVERT_FROM(f32); break;
+        case SF_DTYPE_I32: SF_CONVERT_FROM(i32); break;
+        case SF_DTYPE_U8:  SF_CONVERT_FROM(u8); break;
+        default: return false;
+    }
+    return true;
+}
+
+#undef SF_CONVERT_FROM
+#undef SF_CONVERT_LOOP
+
+// --- Public ---
+
+static const char* resolve_payload_path(const char* base_path, const char* ref, sf_arena* arena) {
+    if (!base_path || sf_path_is_absolute(ref)) return ref;
+    const char* path = sf_path_join(sf_path_get_dir(base_path, arena), ref, arena);
+    // Same fallback as graph references: paths relative to the working directory
+    if (!sf_file_exists(path) && sf_file_exists(ref)) return ref;
+    return path;
+}
+
+// Fills dst->const_data from a mapped payload. Returns NULL or the reason it failed.
+static const char* copy_payload(sf_ir_node* dst, const sf_file_map* map, bool is_npy, int src_type, size_t data_offset, sf_arena* arena) {
+    u8 ndim = 0;
+    i32 shape[SF_MAX_DIMS] = {0};
+    size_t file_count = 0;
+
+    if (is_npy) {
+        sf_npy_header npy;
+        const char* err = NULL;
+        if (map->size < SF_NPY_MAGIC_SIZE || memcmp(map->data, SF_NPY_MAGIC, SF_NPY_MAGIC_SIZE) != 0) return "not a .npy file";
+        if (!npy_parse_header(map->data, map->size, &npy, arena, &err)) return err;
+        src_type = npy.type;
+        ndim = npy.ndim;
+        memcpy(shape, npy.shape, sizeof(shape));
+        data_offset = npy.data_offset;
+        file_count = ndim == 0 ? 1 : sf_shape_calc_count(shape, ndim);
+        if ((map->size - data_offset) / PAYLOAD_TYPES[src_type].size < file_count) return "payload is truncated";
+    } else {
+        if (src_type < 0) return "raw payload needs a 'dtype'";
+        if (data_offset > map->size || (map->size - data_offset) % PAYLOAD_TYPES[src_type].size != 0) {
+            return "payload size is not a multiple of its element size";
+        }
+        file_count = (map->size - data_offset) / PAYLOAD_TYPES[src_type].size;
+        ndim = file_count == 1 ? 0 : 1;
+        shape[0] = (i32)file_count;
+    }
+
+    // Adopt the payload's dtype and shape when the node declares none, otherwise validate.
+    // A flat payload fills any shape of the same size; a multi-dimensional one must match.
+    if (dst->const_info.dtype == SF_DTYPE_UNKNOWN) {
+        if (PAYLOAD_TYPES[src_type].dtype == SF_DTYPE_UNKNOWN) return "payload element type needs an explicit node 'dtype'";
+        dst->const_info.dtype = PAYLOAD_TYPES[src_type].dtype;
+        dst->out_info.dtype = dst->const_info.dtype;
+    }
+    if (dst->const_info.ndim == 0 && ndim > 0) {
+        dst->const_info.ndim = ndim;
+        memcpy(dst->const_info.shape, shape, sizeof(i32) * ndim);
+        sf_shape_calc_strides(&dst->const_info);
+        dst->out_info = dst->const_info;
+    }
+    size_t count = dst->const_info.ndim == 0 ? 1 : sf_shape_calc_count(dst->const_info.shape, dst->const_info.ndim);
+    if (count != file_count) return "payload element count does not match the constant's shape";
+    if (ndim > 1 && (ndim != dst->const_info.ndim || memcmp(shape, dst->const_info.shape, sizeof(i32) * ndim) != 0)) {
+        return "payload shape does not match the constant's shape";
+    }
+
+    size_t elem_size = PAYLOAD_TYPES[src_type].size;
+    size_t bytes = count * sf_dtype_size(dst->const_info.dtype);
+    dst->const_data = SF_ARENA_PUSH(arena, uint8_t, bytes);
+    const u8* src = map->data + data_offset;
+    if (PAYLOAD_TYPES[src_type].dtype == dst->const_info.dtype) {
+        memcpy(dst->const_data, src, bytes);
+        return NULL;
+    }
+
+    // Unaligned sources (raw offsets, odd npy headers) are staged through an aligned copy
+    void* staged = NULL;
+    if ((uintptr_t)src % elem_size != 0) {
+        staged = malloc(count * elem_size);
+        if (!staged) return "out of memory";
+        memcpy(staged, src, count * elem_size);
+        src = (const u8*)staged;
+    }
+    bool ok = convert_payload(dst->const_data, dst->const_info.dtype, src, src_type, count);
+    free(staged);
+    return ok ? NULL : "cannot convert payload to the constant's dtype";
+}
+
+bool sf_ir_load_const_payload(sf_ir_node* dst, const sf_json_value* ref, const char* base_path, sf_arena* arena, sf_compiler_diag* diag) {
+    const sf_json_value* path_val = sf_json_get_field(ref, "path");
+    if (!path_val || path_val->type != SF_JSON_VAL_STRING) {
+        sf_compiler_diag_report(diag, dst->loc, "Constant '%s': external 'value' needs a 'path' string", dst->id);
+        return false;
+    }
+    const char* path = resolve_payload_path(base_path, path_val->as.s, arena);
+
+    // Raw element type: the reference's 'dtype', else the node's own (.npy files carry theirs)
+    int src_type = payload_type_from_dtype(dst->const_info.dtype);
+    const sf_json_value* dtype_val = sf_json_get_field(ref, "dtype");
+    if (dtype_val && dtype_val->type == SF_JSON_VAL_STRING) {
+        src_type = payload_type_from_name(dtype_val->as.s);
+        if (src_type < 0) {
+            sf_compiler_diag_report(diag, dst->loc, "Constant '%s': unknown payload dtype '%s'", dst->id, dtype_val->as.s);
+            return false;
+        }
+    }
+    const sf_json_value* offset_val = sf_json_get_field(ref, "offset");
+    double offset = (offset_val && offset_val->type == SF_JSON_VAL_NUMBER) ? offset_val->as.n : 0.0;
+    if (offset < 0.0) {
+        sf_compiler_diag_report(diag, dst->loc, "Constant '%s': negative payload offset", dst->id);
+        return false;
+    }
+
+    sf_file_map map;
+    if (!sf_file_map_open(&map, path)) {
+        sf_compiler_diag_report(diag, dst->loc, "Constant '%s': cannot map payload '%s'", dst->id, path);
+        return false;
+    }
+    bool is_npy = strcmp(sf_path_get_ext(path), "npy") == 0 ||
+                  (map.size >= SF_NPY_MAGIC_SIZE && memcmp(map.data, SF_NPY_MAGIC, SF_NPY_MAGIC_SIZE) == 0);
+    const char* err = copy_payload(dst, &map, is_npy, src_type, (size_t)offset, arena);
+    sf_file_map_close(&map);
+
+    if (err) {
+        sf_compiler_diag_report(diag, dst->loc, "Constant '%s': %s ('%s')", dst->id, err, path);
+        return false;
+    }
+    SF_LOG_DEBUG("Constant '%s': loaded from '%s'", dst->id, path);
+    return true;
+}
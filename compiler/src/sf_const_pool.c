@@ -0,0 +1,282 @@
+#include <sionflow/compiler/sf_compiler.h>
+#include "sf_compiler_internal.h"
+#include <sionflow/base/sf_log.h>
+#include <sionflow/base/sf_shape.h>
+#include <string.h>
+
+/**
+ * Shared Constant Pool
+ * Kernels of one cartridge often embed the same LUTs and weight tables. Payloads that occur
+ * more than once (by content, within one program or across several) are stored once in a single
+ * RAW "constants" section, together with one reference table per program that uses them. Those
+ * programs no longer carry the pooled payloads; sf_const_pool_resolve points them back into the
+ * section at load time. Layout (native byte order, offsets from the start of the section):
+ *   header | entry[entry_count] { offset, size } | table[table_count] { name, tensor_count, indices }
+ *   | u32 pool index per tensor (SF_CONST_POOL_NONE: kept in the program) | names | data (16-byte aligned)
+ * Constants used once stay in their program, so a cartridge without duplicates is unchanged.
+ */
+
+#define SF_CONST_POOL_MAGIC 0x50434653u // "SFCP"
+#define SF_CONST_POOL_VERSION 1
+#define SF_CONST_POOL_ALIGN 16
+#define SF_CONST_POOL_NONE UINT32_MAX
+
+typedef struct {
+    u32 magic;
+    u32 version;
+    u32 entry_count;
+    u32 table_count;
+    u64 data_offset;
+    u64 data_size;
+} sf_const_pool_header;
+
+typedef struct {
+    u64 offset; // From data_offset
+    u64 size;
+} sf_const_pool_entry;
+
+typedef struct {
+    u32 name_offset;  // NUL-terminated program section name
+    u32 tensor_count;
+    u32 index_offset; // tensor_count pool indices
+    u32 reserved;
+} sf_const_pool_table;
+
+// One distinct payload
+typedef struct {
+    const void* data;
+    u64 size;
+    u64 hash;
+    u32 uses;
+    u32 pool_idx;
+} sf_const_payload;
+
+// One CONST tensor of one program
+typedef struct {
+    u32 section;
+    u32 tensor;
+    u32 payload;
+} sf_const_use;
+
+static u64 tensor_bytes(const sf_type_info* info) {
+    size_t count = sf_shape_calc_count(info->shape, info->ndim);
+    if (count == 0) count = 1;
+    return (u64)count * sf_dtype_size(info->dtype);
+}
+
+static u64 align_up(u64 v, u64 a) {
+    return (v + a - 1) & ~(a - 1);
+}
+
+// Index of the payload with identical bytes, adding it when new
+static u32 intern_payload(sf_const_payload* payloads, u32* payload_count, u32* slots, u32 slot_mask, const void* data, u64 size) {
+    u64 h = sf_hash64(data, (size_t)size, sf_hash64(&size, sizeof(size), SF_HASH64_SEED));
+    for (u32 s = (u32)h & slot_mask;; s = (s + 1) & slot_mask) {
+        if (slots[s] == SF_CONST_POOL_NONE) {
+            u32 idx = (*payload_count)++;
+            payloads[idx] = (sf_const_payload){ data, size, h, 0, SF_CONST_POOL_NONE };
+            slots[s] = idx;
+            return idx;
+        }
+        const sf_const_payload* p = &payloads[slots[s]];
+        if (p->hash == h && p->size == size && (p->data == data || memcmp(p->data, data, (size_t)size) == 0)) return slots[s];
+    }
+}
+
+bool sf_const_pool_share(const sf_section_desc* sections, u32 section_count, sf_arena* arena, sf_section_desc** out_sections, u32* out_count, sf_const_pool_stats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    *out_sections = (sf_section_desc*)sections;
+    *out_count = section_count;
+
+    // 1. Every constant payload of every program
+    u32 use_count = 0;
+    for (u32 s = 0; s < section_count; ++s) {
+        if (sections[s].type != SF_SECTION_PROGRAM) continue;
+        const sf_program* prog = (const sf_program*)sections[s].data;
+        for (u32 t = 0; t < prog->meta.tensor_count; ++t) {
+            if (prog->tensor_data[t]) use_count++;
+        }
+    }
+    if (use_count == 0) return true;
+
+    u32 slot_count = 16;
+    while (slot_count < use_count * 2) slot_count <<= 1;
+    sf_const_use* uses = SF_ARENA_PUSH(arena, sf_const_use, use_count);
+    sf_const_payload* payloads = SF_ARENA_PUSH(arena, sf_const_payload, use_count);
+    u32* slots = SF_ARENA_PUSH(arena, u32, slot_count);
+    if (!uses || !payloads || !slots) return false;
+    memset(slots, 0xFF, sizeof(u32) * slot_count);
+
+    // 2. Deduplicate by content
+    u32 payload_count = 0, n = 0;
+    for (u32 s = 0; s < section_count; ++s) {
+        if (sections[s].type != SF_SECTION_PROGRAM) continue;
+        const sf_program* prog = (const sf_program*)sections[s].data;
+        for (u32 t = 0; t < prog->meta.tensor_count; ++t) {
+            if (!prog->tensor_data[t]) continue;
+            u64 size = tensor_bytes(&prog->tensor_infos[t]);
+            u32 p = intern_payload(payloads, &payload_count, slots, slot_count - 1, prog->tensor_data[t], size);
+            payloads[p].uses++;
+            uses[n++] = (sf_const_use){ s, t, p };
+            stats->constant_count++;
+            stats->bytes_before += size;
+        }
+    }
+
+    // 3. Pool entries: payloads used more than once, in first-use order
+    u32 pool_count = 0;
+    u64 data_size = 0;
+    for (u32 p = 0; p < payload_count; ++p) {
+        if (payloads[p].uses < 2) {
+            stats->bytes_after += payloads[p].size * payloads[p].uses;
+            continue;
+        }
+        payloads[p].pool_idx = pool_count++;
+        data_size = align_up(data_size, SF_CONST_POOL_ALIGN) + payloads[p].size;
+        stats->shared_count += payloads[p].uses;
+        stats->bytes_after += payloads[p].size;
+    }
+    stats->pool_entry_count = pool_count;
+    if (pool_count == 0) return true;
+
+    // 4. Programs that reference the pool get a table
+    u32 table_count = 0, index_count = 0;
+    u64 names_size = 0;
+    u32* first_use = SF_ARENA_PUSH(arena, u32, section_count);
+    if (!first_use) return false;
+    memset(first_use, 0xFF, sizeof(u32) * section_count);
+    for (u32 u = 0; u < use_count; ++u) {
+        u32 s = uses[u].section;
+        if (payloads[uses[u].payload].pool_idx == SF_CONST_POOL_NONE || first_use[s] != SF_CONST_POOL_NONE) continue;
+        first_use[s] = u;
+        table_count++;
+        index_count += ((const sf_program*)sections[s].data)->meta.tensor_count;
+        names_size += strlen(sections[s].name) + 1;
+    }
+    if (section_count + 1 > SF_MAX_SECTIONS) {
+        SF_LOG_ERROR("Too many cartridge sections for a shared constant pool (max %d)", SF_MAX_SECTIONS);
+        return false;
+    }
+
+    u64 entries_offset = sizeof(sf_const_pool_header);
+    u64 tables_offset = entries_offset + sizeof(sf_const_pool_entry) * pool_count;
+    u64 indices_offset = tables_offset + sizeof(sf_const_pool_table) * table_count;
+    u64 names_offset = indices_offset + sizeof(u32) * index_count;
+    u64 data_offset = align_up(names_offset + names_size, SF_CONST_POOL_ALIGN);
+    u64 pool_size = data_offset + data_size;
+    if (pool_size > UINT32_MAX) {
+        SF_LOG_ERROR("Shared constant pool exceeds 4 GB");
+        return false;
+    }
+
+    // 5. The pool section
+    u8* pool = SF_ARENA_PUSH(arena, u8, pool_size);
+    sf_section_desc* out = SF_ARENA_PUSH(arena, sf_section_desc, section_count + 1);
+    if (!pool || !out) return false;
+    memset(pool, 0, (size_t)pool_size);
+    sf_const_pool_header header = { SF_CONST_POOL_MAGIC, SF_CONST_POOL_VERSION, pool_count, table_count, data_offset, data_size };
+    memcpy(pool, &header, sizeof(header));
+    sf_const_pool_entry* entries = (sf_const_pool_entry*)(pool + entries_offset);
+    u64 offset = 0;
+    for (u32 p = 0; p < payload_count; ++p) {
+        if (payloads[p].pool_idx == SF_CONST_POOL_NONE) continue;
+        offset = align_up(offset, SF_CONST_POOL_ALIGN);
+        entries[payloads[p].pool_idx] = (sf_const_pool_entry){ offset, payloads[p].size };
+        memcpy(pool + data_offset + offset, payloads[p].data, (size_t)payloads[p].size);
+        offset += payloads[p].size;
+    }
+
+    // 6. Tables, and program copies without the pooled payloads
+    sf_const_pool_table* tables = (sf_const_pool_table*)(pool + tables_offset);
+    u32* indices = (u32*)(pool + indices_offset);
+    char* names = (char*)(pool + names_offset);
+    memset(indices, 0xFF, sizeof(u32) * index_count);
+    u32 count = 0, table = 0;
+    out[count++] = (sf_section_desc){ "constants", SF_SECTION_RAW, pool, (u32)pool_size };
+    for (u32 s = 0; s < section_count; ++s) {
+        if (first_use[s] == SF_CONST_POOL_NONE) {
+            out[count++] = sections[s];
+            continue;
+        }
+        const sf_program* src = (const sf_program*)sections[s].data;
+        u32 tensor_count = src->meta.tensor_count;
+        sf_program* prog = SF_ARENA_PUSH(arena, sf_program, 1);
+        void** tensor_data = SF_ARENA_PUSH(arena, void*, tensor_count);
+        if (!prog || !tensor_data) return false;
+        *prog = *src;
+        memcpy(tensor_data, src->tensor_data, sizeof(void*) * tensor_count);
+        prog->tensor_data = tensor_data;
+
+        size_t name_size = strlen(sections[s].name) + 1;
+        memcpy(names, sections[s].name, name_size);
+        tables[table] = (sf_const_pool_table){ (u32)((u8*)names - pool), tensor_count, (u32)((u8*)indices - pool), 0 };
+        for (u32 u = first_use[s]; u < use_count && uses[u].section == s; ++u) {
+            u32 idx = payloads[uses[u].payload].pool_idx;
+            if (idx == SF_CONST_POOL_NONE) continue;
+            indices[uses[u].tensor] = idx;
+            tensor_data[uses[u].tensor] = NULL;
+        }
+        names += name_size;
+        indices += tensor_count;
+        table++;
+
+        out[count++] = (sf_section_desc){ sections[s].name, SF_SECTION_PROGRAM, prog, sections[s].size };
+    }
+
+    *out_sections = out;
+    *out_count = count;
+    return true;
+}
+
+bool sf_const_pool_resolve(const void* pool, size_t pool_size, const char* program_name, sf_program* prog) {
+    const u8* base = (const u8*)pool;
+    sf_const_pool_header header;
+    if (!pool || pool_size < sizeof(header)) goto corrupt;
+    memcpy(&header, base, sizeof(header));
+    if (header.magic != SF_CONST_POOL_MAGIC) goto corrupt;
+    if (header.version != SF_CONST_POOL_VERSION) {
+        SF_LOG_ERROR("Shared constant pool: unsupported version %u (expected %u)", header.version, SF_CONST_POOL_VERSION);
+        return false;
+    }
+    // Bounds are checked before any size is computed from them, so a corrupt header cannot wrap
+    u64 tables_offset = sizeof(header) + (u64)header.entry_count * sizeof(sf_const_pool_entry);
+    if (header.entry_count > pool_size / sizeof(sf_const_pool_entry) ||
+        header.table_count > pool_size / sizeof(sf_const_pool_table) ||
+        tables_offset + (u64)header.table_count * sizeof(sf_const_pool_table) > pool_size ||
+        header.data_offset > pool_size || header.data_size > pool_size - header.data_offset) goto corrupt;
+
+    sf_const_pool_table t;
+    bool found = false;
+    for (u32 i = 0; i < header.table_count && !found; ++i) {
+        memcpy(&t, base + tables_offset + (u64)i * sizeof(t), sizeof(t));
+        if (t.name_offset >= pool_size || !memchr(base + t.name_offset, '\0', pool_size - t.name_offset)) goto corrupt;
+        found = strcmp((const char*)base + t.name_offset, program_name) == 0;
+    }
+    if (!found) return true; // Nothing of this program is pooled
+
+    if (t.tensor_count != prog->meta.tensor_count) {
+        SF_LOG_ERROR("Shared constant pool: '%s' has %u tensors, its table %u", program_name, prog->meta.tensor_count, t.tensor_count);
+        return false;
+    }
+    if (t.index_offset > pool_size || (u64)t.tensor_count * sizeof(u32) > pool_size - t.index_offset) goto corrupt;
+
+    for (u32 i = 0; i < t.tensor_count; ++i) {
+        u32 idx;
+        memcpy(&idx, base + t.index_offset + (u64)i * sizeof(idx), sizeof(idx));
+        if (idx == SF_CONST_POOL_NONE) continue;
+        if (idx >= header.entry_count) goto corrupt;
+        sf_const_pool_entry e;
+        memcpy(&e, base + sizeof(header) + (u64)idx * sizeof(e), sizeof(e));
+        if (e.offset > header.data_size || e.size > header.data_size - e.offset) goto corrupt;
+        if (prog->tensor_data[i] || e.size != tensor_bytes(&prog->tensor_infos[i])) {
+            SF_LOG_ERROR("Shared constant pool: tensor %u of '%s' does not match pool entry %u", i, program_name, idx);
+            return false;
+        }
+        prog->tensor_data[i] = (void*)(base + header.data_offset + e.offset);
+    }
+    return true;
+
+corrupt:
+    SF_LOG_ERROR("Shared constant pool: corrupt 'constants' section");
+    return false;
+}
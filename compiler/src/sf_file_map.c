@@ -0,0 +1,58 @@
+#include "sf_compiler_internal.h"
+#include <string.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Read-only File Mapping
+ * Whole-file mmap / MapViewOfFile for loaders that only read their input once (binary IR,
+ * constant payloads), so large files are paged in on demand instead of copied with fread.
+ */
+
+bool sf_file_map_open(sf_file_map* map, const char* path) {
+    memset(map, 0, sizeof(*map));
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) { CloseHandle(file); return false; }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) { CloseHandle(file); return false; }
+    map->data = (const u8*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!map->data) { CloseHandle(mapping); CloseHandle(file); return false; }
+    map->size = (size_t)size.QuadPart;
+    map->file = file;
+    map->mapping = mapping;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { close(fd); return false; }
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping keeps the file referenced
+    if (data == MAP_FAILED) return false;
+    map->data = (const u8*)data;
+    map->size = (size_t)st.st_size;
+#endif
+    return true;
+}
+
+void sf_file_map_close(sf_file_map* map) {
+    if (!map->data) return;
+#ifdef _WIN32
+    UnmapViewOfFile(map->data);
+    CloseHandle((HANDLE)map->mapping);
+    CloseHandle((HANDLE)map->file);
+#else
+    munmap((void*)map->data, map->size);
+#endif
+    map->data = NULL;
+}
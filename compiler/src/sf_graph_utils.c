@@ -5,6 +5,7 @@
 #include <sionflow/base/sf_utils.h>
 #include "sf_compiler_internal.h"
 #include <string.h>
+#include <stdio.h>
 
 sf_ir_node* sf_ir_node_add(sf_graph_ir* ir, sf_arena* arena, const char* id, sf_node_type type) {
     if (ir->node_count >= ir->node_cap) return NULL;
@@ -17,6 +18,20 @@ sf_ir_node* sf_ir_node_add(sf_graph_ir* ir, sf_arena* arena, const char* id, sf_
     return node;
 }
 
+bool sf_ir_graph_reserve(sf_graph_ir* ir, sf_arena* arena, size_t extra_nodes) {
+    size_t needed = ir->node_count + extra_nodes;
+    if (needed <= ir->node_cap) return true;
+    size_t new_cap = ir->node_cap ? ir->node_cap * 2 : 64;
+    if (new_cap < needed) new_cap = needed;
+    // Links are index-based, so relocating the node array keeps the graph intact
+    sf_ir_node* nodes = SF_ARENA_PUSH(arena, sf_ir_node, new_cap);
+    if (!nodes) return false;
+    if (ir->node_count) memcpy(nodes, ir->nodes, sizeof(sf_ir_node) * ir->node_count);
+    ir->nodes = nodes;
+    ir->node_cap = new_cap;
+    return true;
+}
+
 void sf_ir_node_remove(sf_graph_ir* ir, u32 node_idx) {
     if (node_idx < ir->node_count) {
         ir->nodes[node_idx].type = SF_NODE_UNKNOWN;
@@ -199,30 +214,23 @@ bool sf_ir_node_replace_with_subgraph(sf_graph_ir* ir, u32 node_idx, const sf_lo
     sf_builder_remove_node(ir, node_idx); return true;
 }
 
-bool sf_ir_node_try_fuse(sf_graph_ir* ir, u32 node_idx, const sf_fusion_rule* rule, sf_arena* arena) {
-    sf_ir_node* target = &ir->nodes[node_idx];
-    if (target->type != rule->target_type) return false;
-    u32 m[2] = { UINT32_MAX, UINT32_MAX };
-    for (u8 i = 0; i < rule->match_count; ++i) {
-        u32 pi = sf_compiler_get_port_index(target->type, rule->matches[i].port_name);
-        sf_port src = sf_builder_get_source(ir, (sf_port){ node_idx, pi });
-        if (SF_PORT_IS_NULL(src) || ir->nodes[src.node_idx].type != rule->matches[i].match_type) return false;
-        m[i] = src.node_idx;
-    }
-    sf_ir_node* f = sf_ir_node_add(ir, arena, sf_arena_sprintf(arena, "%s_f", target->id), rule->replace_with);
-    u32 fused_idx = (u32)(f - ir->nodes);
-    f->loc = target->loc; f->domain_node_idx = target->domain_node_idx;
+u32 sf_ir_node_try_fuse(sf_graph_ir* ir, u32 node_idx, sf_arena* arena) {
+    sf_fusion_binding m;
+    const sf_fusion_pattern* rule = sf_fusion_match_node(ir, node_idx, &m);
+    if (!rule || !sf_ir_graph_reserve(ir, arena, SF_FUSION_MAX_NODES)) return UINT32_MAX;
+
+    u32 fused_idx = rule->build(ir, arena, node_idx, &m);
+    ir->nodes[fused_idx].out_info = ir->nodes[node_idx].out_info;
     sf_builder_replace_node(ir, node_idx, fused_idx);
-    for (u8 i = 0; i < rule->match_count; ++i) {
-        u32 target_p = sf_compiler_get_port_index(f->type, rule->matches[i].remap_to_port);
-        const sf_op_metadata* m_meta = &SF_OP_METADATA[ir->nodes[m[i]].type];
-        for (u32 p = 0; p < 4; ++p) if (m_meta->ports[p]) {
-            sf_port s = sf_builder_get_source(ir, (sf_port){ m[i], p });
-            if (!SF_PORT_IS_NULL(s)) sf_builder_connect(ir, arena, s, (sf_port){ fused_idx, target_p + p });
-        }
-        sf_builder_remove_node(ir, m[i]);
+    sf_builder_remove_node(ir, node_idx);
+
+    // Pre-order guarantees a parent releases its inputs before its children are checked.
+    // Interior nodes that are still used elsewhere (use_count > 1) or feed the replacement stay.
+    for (u8 i = 0; i < m.absorbed_count; ++i) {
+        sf_ir_node* n = &ir->nodes[m.absorbed[i]];
+        if (n->type != SF_NODE_UNKNOWN && !n->users) sf_builder_remove_node(ir, m.absorbed[i]);
     }
-    sf_builder_remove_node(ir, node_idx); return true;
+    return fused_idx;
 }
 
 u32* sf_ir_graph_graft(sf_graph_ir* dst, const sf_graph_ir* src, const char* prefix, sf_arena* arena) {
@@ -277,21 +285,61 @@ bool sf_ir_node_inline(sf_graph_ir* ir, u32 call_node_idx, const sf_graph_ir* su
     sf_builder_remove_node(ir, call_node_idx); return true;
 }
 
-static bool sort_recursive(sf_graph_ir* ir, u32 node_idx, bool* visited, bool* stack, u32* order, u32* count, sf_compiler_diag* diag) {
-    if (stack[node_idx]) return false;
-    if (visited[node_idx]) return true;
-    visited[node_idx] = stack[node_idx] = true;
-    sf_ir_node* node = &ir->nodes[node_idx];
-    for (int p = 0; p < 4; ++p) {
-        u32 s_idx = node->inputs[p].src_node_idx;
-        if (s_idx != UINT32_MAX) if (!sort_recursive(ir, s_idx, visited, stack, order, count, diag)) return false;
+typedef struct {
+    u32 node_idx;
+    u32 next_port;
+} sf_sort_frame;
+
+static void report_cycle(sf_graph_ir* ir, const sf_sort_frame* stack, u32 depth, u32 back_idx, sf_compiler_diag* diag) {
+    // Frames above the re-entered node form the cycle; each frame consumes the one above it
+    u32 first = depth;
+    while (first > 0 && stack[first - 1].node_idx != back_idx) first--;
+
+    char path[200];
+    size_t len = (size_t)snprintf(path, sizeof(path), "%s", ir->nodes[back_idx].id);
+    for (u32 i = depth; i-- > first && len < sizeof(path);) {
+        len += (size_t)snprintf(path + len, sizeof(path) - len, " -> %s", ir->nodes[stack[i].node_idx].id);
     }
-    stack[node_idx] = false; order[(*count)++] = node_idx; return true;
+    if (len < sizeof(path)) snprintf(path + len, sizeof(path) - len, " -> %s", ir->nodes[back_idx].id);
+    SF_REPORT_NODE(diag, &ir->nodes[back_idx], "Sort Error: Cycle detected (%s)", path);
 }
 
 bool sf_ir_graph_sort(sf_graph_ir* ir, u32* out_order, sf_arena* arena, sf_compiler_diag* diag) {
-    bool *v = SF_ARENA_PUSH(arena, bool, ir->node_count), *s = SF_ARENA_PUSH(arena, bool, ir->node_count);
-    memset(v, 0, ir->node_count); memset(s, 0, ir->node_count); u32 c = 0;
-    for (u32 i = 0; i < ir->node_count; ++i) if (ir->nodes[i].type != SF_NODE_UNKNOWN && !v[i]) if (!sort_recursive(ir, i, v, s, out_order, &c, diag)) return false;
+    // Iterative post-order DFS: roots in index order, inputs in port order. Same order as
+    // the recursive walk it replaces, without its stack depth limit on long chains.
+    enum { SF_SORT_NEW = 0, SF_SORT_OPEN = 1, SF_SORT_DONE = 2 };
+    u32 n = (u32)ir->node_count;
+    u8* state = SF_ARENA_PUSH(arena, u8, n);
+    sf_sort_frame* stack = SF_ARENA_PUSH(arena, sf_sort_frame, n);
+    memset(state, 0, n);
+    u32 c = 0;
+
+    for (u32 root = 0; root < n; ++root) {
+        if (ir->nodes[root].type == SF_NODE_UNKNOWN || state[root] != SF_SORT_NEW) continue;
+        u32 depth = 0;
+        stack[depth++] = (sf_sort_frame){ root, 0 };
+        state[root] = SF_SORT_OPEN;
+
+        while (depth > 0) {
+            sf_sort_frame* top = &stack[depth - 1];
+            if (top->next_port == 4) {
+                state[top->node_idx] = SF_SORT_DONE;
+                out_order[c++] = top->node_idx;
+                depth--;
+                continue;
+            }
+            u32 s_idx = ir->nodes[top->node_idx].inputs[top->next_port++].src_node_idx;
+            if (s_idx == UINT32_MAX || state[s_idx] == SF_SORT_DONE) continue;
+            if (state[s_idx] == SF_SORT_OPEN) {
+                report_cycle(ir, stack, depth, s_idx, diag);
+                return false;
+            }
+            state[s_idx] = SF_SORT_OPEN;
+            stack[depth++] = (sf_sort_frame){ s_idx, 0 };
+        }
+    }
+
+    // Removed nodes go last so 'out_order' is always a full permutation
+    for (u32 i = 0; i < n; ++i) if (state[i] == SF_SORT_NEW) out_order[c++] = i;
     return true;
 }
@@ -18,6 +18,54 @@ typedef struct {
 #define SF_PORT_NULL ((sf_port){UINT32_MAX, 0})
 #define SF_PORT_IS_NULL(p) ((p).node_idx == UINT32_MAX)
 
+// --- Fusion Rules ---
+// Fusion patterns are nested DAGs rooted at 'target_type'. The generator compiles every pattern
+// into a matcher (dispatched by an opcode switch) and every replacement into a builder.
+
+#define SF_FUSION_MAX_NODES 8
+#define SF_FUSION_MAX_CAPTURES 8
+
+typedef struct {
+    u32 absorbed[SF_FUSION_MAX_NODES]; // Interior pattern nodes in pre-order (root excluded)
+    u8 absorbed_count;
+    sf_port captures[SF_FUSION_MAX_CAPTURES]; // Sources bound to '$name' leaves
+} sf_fusion_binding;
+
+typedef struct {
+    const char* id;
+    sf_node_type target_type;
+    sf_node_type replace_with; // Root op of the replacement
+    u32 (*build)(sf_graph_ir* ir, sf_arena* arena, u32 root, const sf_fusion_binding* m);
+} sf_fusion_pattern;
+
+extern const sf_fusion_pattern SF_FUSION_PATTERNS[];
+extern const size_t SF_FUSION_PATTERN_COUNT;
+
+// Returns the first rule (in spec order) whose pattern matches at 'node_idx', or NULL.
+const sf_fusion_pattern* sf_fusion_match_node(sf_graph_ir* ir, u32 node_idx, sf_fusion_binding* out);
+
+// --- Algebraic Rules ---
+// Peephole identities declared next to the fusion rules. Ops are kept by name and resolved
+// when the pass runs, so rules for ops the ISA does not provide simply never fire.
+
+typedef enum {
+    SF_ALGEBRA_IDENTITY,   // op(x, c) -> x          when every element of c equals 'constant'
+    SF_ALGEBRA_ABSORB,     // op(x, c) -> c          when every element of c equals 'constant'
+    SF_ALGEBRA_RECIPROCAL, // op(x, c) -> with(x, 1/c)
+} sf_algebraic_kind;
+
+typedef struct {
+    const char* id;
+    sf_algebraic_kind kind;
+    const char* op;
+    const char* port;  // Port of the constant operand; NULL accepts any port
+    const char* with;  // Replacement op (RECIPROCAL)
+    f64 constant;
+} sf_algebraic_rule;
+
+extern const sf_algebraic_rule SF_ALGEBRAIC_RULES[];
+extern const size_t SF_ALGEBRAIC_RULE_COUNT;
+
 // --- Graph Builder API ---
 
 void sf_builder_connect(sf_graph_ir* ir, sf_arena* arena, sf_port src, sf_port dst);
@@ -29,6 +77,7 @@ void sf_builder_remove_node(sf_graph_ir* ir, u32 node_idx);
 // --- Basic Manipulations ---
 
 sf_ir_node* sf_ir_node_add(sf_graph_ir* ir, sf_arena* arena, const char* id, sf_node_type type);
+bool sf_ir_graph_reserve(sf_graph_ir* ir, sf_arena* arena, size_t extra_nodes); // May move ir->nodes
 void sf_ir_node_remove(sf_graph_ir* ir, u32 node_idx);
 
 u32 sf_compiler_get_port_index(sf_node_type type, const char* port_name);
@@ -40,7 +89,7 @@ bool sf_ir_graph_sort(sf_graph_ir* ir, u32* out_order, sf_arena* arena, sf_compi
 
 void sf_ir_links_remap_node(sf_graph_ir* ir, u32 old_node_idx, u32 new_node_idx);
 bool sf_ir_node_replace_with_subgraph(sf_graph_ir* ir, u32 node_idx, const sf_lowering_rule* rule, sf_arena* arena, sf_compiler_diag* diag);
-bool sf_ir_node_try_fuse(sf_graph_ir* ir, u32 node_idx, const sf_fusion_rule* rule, sf_arena* arena);
+u32 sf_ir_node_try_fuse(sf_graph_ir* ir, u32 node_idx, sf_arena* arena); // Fused root or UINT32_MAX
 bool sf_ir_node_inline(sf_graph_ir* ir, u32 call_node_idx, const sf_graph_ir* subgraph, const char* prefix, sf_arena* arena);
 u32* sf_ir_graph_graft(sf_graph_ir* dst, const sf_graph_ir* src, const char* prefix, sf_arena* arena);
 
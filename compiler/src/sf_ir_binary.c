@@ -0,0 +1,413 @@
+#include <sionflow/compiler/sf_compiler.h>
+#include "sf_compiler_internal.h"
+#include <sionflow/base/sf_utils.h>
+#include <sionflow/base/sf_log.h>
+#include <sionflow/base/sf_shape.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Binary IR (.sfir)
+ * Lowered graphs in a flat, versioned file that loads without parsing: the file is mapped,
+ * node records are expanded straight from the mapping in a single sweep, and only the
+ * strings and constant blob (which IDs, paths and payloads keep pointing into) are copied
+ * into the arena, with one memcpy. Layout (native byte order, all sections
+ * 16-byte aligned, sizes follow from the header counts):
+ *   header | op names | nodes | user offsets (CSR) | users | strings | constant blob
+ * Node types are stored by ISA name so a library survives reordering of the op table.
+ * CALL paths below the .sfir's own directory are stored relative to it and resolved against
+ * that directory on load, so a library can be moved together with its sub-graphs.
+ */
+
+#define SF_IR_MAGIC 0x52494653u // "SFIR"
+#define SF_IR_VERSION 1
+#define SF_IR_NONE UINT32_MAX
+#define SF_IR_ALIGN 16
+
+typedef struct {
+    u32 magic;
+    u32 version;
+    u32 node_count;
+    u32 user_count;
+    u32 op_count;
+    u32 strings_size;
+    u64 blob_size;
+    char app_title[SF_MAX_TITLE_NAME];
+    u32 window_width;
+    u32 window_height;
+    u32 num_threads;
+    u8 vsync;
+    u8 fullscreen;
+    u8 resizable;
+    u8 reserved;
+} sf_ir_bin_header;
+
+typedef struct {
+    u8 dtype;
+    u8 ndim;
+    u16 reserved;
+    i32 shape[SF_MAX_DIMS];
+} sf_ir_bin_info;
+
+typedef struct {
+    u32 id;             // String offsets (SF_IR_NONE if absent)
+    u32 sub_graph_path;
+    u32 loc_file;
+    u32 loc_line;
+    u32 loc_column;
+    u32 domain_node_idx;
+    u32 inputs[4][2];   // Source node and port, SF_IR_NONE if unconnected
+    u16 op;             // Index into the op name table
+    u8 resource_flags;
+    u8 relative_path;   // sub_graph_path is relative to the .sfir's directory
+    sf_ir_bin_info const_info;
+    sf_ir_bin_info out_info;
+    u64 const_offset;   // Into the constant blob
+    u64 const_size;     // 0 if the node carries no data
+} sf_ir_bin_node;
+
+typedef struct {
+    u32 node_idx;
+    u32 port_idx;
+} sf_ir_bin_user;
+
+typedef struct {
+    size_t ops, nodes, user_offsets, users, strings, blob, total;
+} sf_ir_bin_layout;
+
+static size_t align_up(size_t v) {
+    return (v + SF_IR_ALIGN - 1) & ~(size_t)(SF_IR_ALIGN - 1);
+}
+
+static sf_ir_bin_layout compute_layout(const sf_ir_bin_header* h) {
+    sf_ir_bin_layout l;
+    l.ops = align_up(sizeof(sf_ir_bin_header));
+    l.nodes = align_up(l.ops + sizeof(u32) * h->op_count);
+    l.user_offsets = align_up(l.nodes + sizeof(sf_ir_bin_node) * h->node_count);
+    l.users = align_up(l.user_offsets + sizeof(u32) * ((size_t)h->node_count + 1));
+    l.strings = align_up(l.users + sizeof(sf_ir_bin_user) * h->user_count);
+    l.blob = align_up(l.strings + h->strings_size);
+    l.total = l.blob + (size_t)h->blob_size;
+    return l;
+}
+
+// Bytes of constant data described by 'info' (scalars count one element)
+static u64 info_bytes(const sf_type_info* info) {
+    size_t count = sf_shape_calc_count(info->shape, info->ndim);
+    if (count == 0) count = 1;
+    return (u64)count * sf_dtype_size(info->dtype);
+}
+
+static size_t const_bytes(const sf_ir_node* node) {
+    return node->const_data ? (size_t)info_bytes(&node->const_info) : 0;
+}
+
+static sf_ir_bin_info pack_info(const sf_type_info* info) {
+    sf_ir_bin_info out;
+    memset(&out, 0, sizeof(out));
+    out.dtype = (u8)info->dtype;
+    out.ndim = info->ndim;
+    for (u8 d = 0; d < info->ndim && d < SF_MAX_DIMS; ++d) out.shape[d] = info->shape[d];
+    return out;
+}
+
+static void unpack_info(const sf_ir_bin_info* in, sf_type_info* out) {
+    memset(out, 0, sizeof(*out));
+    out->dtype = (sf_dtype)in->dtype;
+    out->ndim = in->ndim;
+    for (u8 d = 0; d < in->ndim; ++d) out->shape[d] = in->shape[d];
+    sf_shape_calc_strides(out);
+}
+
+// --- Writer ---
+
+// Interned string table: every distinct string is stored once
+typedef struct {
+    char* data;
+    u32 size;
+    u32 cap;
+    u32* slots; // Offsets, open addressing over sf_hash64_str
+    u32 slot_mask;
+} sf_ir_strtab;
+
+static bool strtab_init(sf_ir_strtab* t, u32 expected) {
+    u32 slot_count = 64;
+    while (slot_count < expected * 2) slot_count *= 2;
+    t->slots = malloc(sizeof(u32) * slot_count);
+    t->slot_mask = slot_count - 1;
+    t->cap = 4096;
+    t->size = 0;
+    t->data = malloc(t->cap);
+    if (!t->slots || !t->data) return false;
+    for (u32 i = 0; i < slot_count; ++i) t->slots[i] = SF_IR_NONE;
+    return true;
+}
+
+static u32 strtab_add(sf_ir_strtab* t, const char* s) {
+    if (!s) return SF_IR_NONE;
+    u32 slot = (u32)sf_hash64_str(s, SF_HASH64_SEED) & t->slot_mask;
+    while (t->slots[slot] != SF_IR_NONE) {
+        if (strcmp(t->data + t->slots[slot], s) == 0) return t->slots[slot];
+        slot = (slot + 1) & t->slot_mask;
+    }
+    size_t len = strlen(s) + 1;
+    if (t->size + len > t->cap) {
+        while (t->size + len > t->cap) t->cap *= 2;
+        char* data = realloc(t->data, t->cap);
+        if (!data) return SF_IR_NONE;
+        t->data = data;
+    }
+    memcpy(t->data + t->size, s, len);
+    t->slots[slot] = t->size;
+    t->size += (u32)len;
+    return t->slots[slot];
+}
+
+// Directory prefix of 'path' including the trailing separator (0 if there is none)
+static size_t dir_prefix_len(const char* path) {
+    if (!path) return 0;
+    const char* a = strrchr(path, '/');
+    const char* b = strrchr(path, '\\');
+    const char* sep = (a && b) ? (a > b ? a : b) : (a ? a : b);
+    return sep ? (size_t)(sep - path) + 1 : 0;
+}
+
+bool sf_compile_save_ir(const sf_graph_ir* ir, const char* path) {
+    if (!ir || !path) return false;
+    u32 node_count = (u32)ir->node_count;
+
+    sf_ir_bin_header header;
+    memset(&header, 0, sizeof(header));
+    header.magic = SF_IR_MAGIC;
+    header.version = SF_IR_VERSION;
+    header.node_count = node_count;
+    strncpy(header.app_title, ir->app_title, SF_MAX_TITLE_NAME - 1);
+    header.window_width = ir->window_width;
+    header.window_height = ir->window_height;
+    header.num_threads = ir->num_threads;
+    header.vsync = ir->vsync;
+    header.fullscreen = ir->fullscreen;
+    header.resizable = ir->resizable;
+
+    sf_ir_strtab strings = {0};
+    size_t dir_len = dir_prefix_len(path);
+    u16 op_index[SF_NODE_COUNT];
+    u32 ops[SF_NODE_COUNT];
+    sf_ir_bin_node* nodes = malloc(sizeof(sf_ir_bin_node) * (node_count ? node_count : 1));
+    u32* user_offsets = malloc(sizeof(u32) * (node_count + 1));
+    bool ok = nodes && user_offsets && strtab_init(&strings, node_count + 16);
+    for (u32 i = 0; i < SF_NODE_COUNT; ++i) op_index[i] = UINT16_MAX;
+
+    // 1. Node records, op table and sizes of the variable sections
+    for (u32 i = 0; ok && i < node_count; ++i) {
+        const sf_ir_node* src = &ir->nodes[i];
+        sf_ir_bin_node* dst = &nodes[i];
+        memset(dst, 0, sizeof(*dst));
+        if (op_index[src->type] == UINT16_MAX) {
+            op_index[src->type] = (u16)header.op_count;
+            ops[header.op_count++] = strtab_add(&strings, SF_OP_METADATA[src->type].name);
+        }
+        dst->op = op_index[src->type];
+        dst->id = strtab_add(&strings, src->id);
+        ok = dst->id != SF_IR_NONE && ops[dst->op] != SF_IR_NONE;
+        dst->loc_file = strtab_add(&strings, src->loc.file);
+        dst->loc_line = src->loc.line;
+        dst->loc_column = src->loc.column;
+        dst->sub_graph_path = SF_IR_NONE;
+        if (src->sub_graph_path) {
+            const char* sub = src->sub_graph_path;
+            if (dir_len && strncmp(sub, path, dir_len) == 0) { sub += dir_len; dst->relative_path = 1; }
+            else if (!dir_len && !sf_path_is_absolute(sub)) dst->relative_path = 1;
+            dst->sub_graph_path = strtab_add(&strings, sub);
+        }
+        dst->domain_node_idx = src->domain_node_idx;
+        for (u32 p = 0; p < 4; ++p) {
+            dst->inputs[p][0] = src->inputs[p].src_node_idx;
+            dst->inputs[p][1] = src->inputs[p].src_node_idx == UINT32_MAX ? 0 : src->inputs[p].src_port_idx;
+        }
+        dst->resource_flags = src->resource_flags;
+        dst->const_info = pack_info(&src->const_info);
+        dst->out_info = pack_info(&src->out_info);
+        dst->const_size = const_bytes(src);
+        dst->const_offset = header.blob_size;
+        header.blob_size = align_up((size_t)(header.blob_size + dst->const_size));
+
+        user_offsets[i] = header.user_count;
+        for (const sf_ir_user* u = src->users; u; u = u->next) header.user_count++;
+    }
+    if (ok) user_offsets[node_count] = header.user_count;
+    header.strings_size = strings.size;
+
+    // 2. Everything goes into one buffer so the file is written in a single call
+    sf_ir_bin_layout layout = compute_layout(&header);
+    u8* buffer = ok ? calloc(1, layout.total) : NULL;
+    if (buffer) {
+        memcpy(buffer, &header, sizeof(header));
+        memcpy(buffer + layout.ops, ops, sizeof(u32) * header.op_count);
+        memcpy(buffer + layout.nodes, nodes, sizeof(sf_ir_bin_node) * node_count);
+        memcpy(buffer + layout.user_offsets, user_offsets, sizeof(u32) * (node_count + 1));
+        sf_ir_bin_user* users = (sf_ir_bin_user*)(buffer + layout.users);
+        for (u32 i = 0; i < node_count; ++i) {
+            const sf_ir_node* src = &ir->nodes[i];
+            u32 u_idx = user_offsets[i];
+            for (const sf_ir_user* u = src->users; u; u = u->next) users[u_idx++] = (sf_ir_bin_user){ u->node_idx, u->port_idx };
+            if (nodes[i].const_size) memcpy(buffer + layout.blob + nodes[i].const_offset, src->const_data, (size_t)nodes[i].const_size);
+        }
+        memcpy(buffer + layout.strings, strings.data, strings.size);
+    }
+
+    FILE* f = buffer ? fopen(path, "wb") : NULL;
+    ok = f != NULL;
+    if (f) {
+        ok = fwrite(buffer, 1, layout.total, f) == layout.total;
+        if (fclose(f) != 0) ok = false;
+    }
+
+    free(buffer);
+    free(strings.data);
+    free(strings.slots);
+    free(user_offsets);
+    free(nodes);
+    return ok;
+}
+
+// --- Reader ---
+
+static sf_node_type op_from_name(const char* name) {
+    for (int i = 0; i < SF_NODE_COUNT; ++i) {
+        if (SF_OP_METADATA[i].name && strcmp(SF_OP_METADATA[i].name, name) == 0) return (sf_node_type)i;
+    }
+    return SF_NODE_COUNT;
+}
+
+static bool valid_info(const sf_ir_bin_info* info) {
+    return info->ndim <= SF_MAX_DIMS && info->dtype < SF_DTYPE_COUNT;
+}
+
+// 'data' is the mapped file: page aligned, so every (aligned) section is read in place
+static bool load_mapped(const u8* data, size_t size, const char* path, sf_source_loc file_loc, sf_graph_ir* out_ir, sf_arena* arena, sf_compiler_diag* diag) {
+    sf_ir_bin_header header;
+    if (size < sizeof(header)) goto corrupt;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != SF_IR_MAGIC) goto corrupt;
+    if (header.version != SF_IR_VERSION) {
+        sf_compiler_diag_report(diag, file_loc, "Unsupported binary IR version %u (expected %u)", header.version, SF_IR_VERSION);
+        return false;
+    }
+    // Bounded before the layout sums them up, so the sums cannot wrap around
+    if (header.op_count > SF_NODE_COUNT || header.blob_size > size || header.strings_size > size) goto corrupt;
+    if ((u64)header.node_count * sizeof(sf_ir_bin_node) > size || (u64)header.user_count * sizeof(sf_ir_bin_user) > size) goto corrupt;
+    sf_ir_bin_layout layout = compute_layout(&header);
+    if (layout.total > size || layout.blob < layout.strings) goto corrupt;
+
+    const u32* ops = (const u32*)(data + layout.ops);
+    const sf_ir_bin_node* nodes = (const sf_ir_bin_node*)(data + layout.nodes);
+    const u32* user_offsets = (const u32*)(data + layout.user_offsets);
+    const sf_ir_bin_user* users = (const sf_ir_bin_user*)(data + layout.users);
+    const char* mapped_strings = (const char*)(data + layout.strings);
+    u32 node_count = header.node_count;
+    if (header.strings_size && mapped_strings[header.strings_size - 1] != '\0') goto corrupt;
+
+    // 1. Op names are resolved once per file, not once per node
+    sf_node_type op_types[SF_NODE_COUNT];
+    for (u32 i = 0; i < header.op_count; ++i) {
+        if (ops[i] >= header.strings_size) goto corrupt;
+        op_types[i] = op_from_name(mapped_strings + ops[i]);
+        if (op_types[i] == SF_NODE_COUNT) {
+            sf_compiler_diag_report(diag, file_loc, "Unknown op '%s' in binary IR", mapped_strings + ops[i]);
+            return false;
+        }
+    }
+
+    // Strings and constants outlive the mapping: copied once (u64 elements keep the blob aligned)
+    size_t tail = layout.total - layout.strings;
+    u8* tail_copy = (u8*)SF_ARENA_PUSH(arena, u64, tail / 8 + 1);
+    if (!tail_copy) goto corrupt;
+    memcpy(tail_copy, data + layout.strings, tail);
+    const char* strings = (const char*)tail_copy;
+    u8* blob = tail_copy + (layout.blob - layout.strings);
+
+    memset(out_ir, 0, sizeof(sf_graph_ir));
+    memcpy(out_ir->app_title, header.app_title, SF_MAX_TITLE_NAME);
+    out_ir->app_title[SF_MAX_TITLE_NAME - 1] = '\0';
+    out_ir->window_width = header.window_width;
+    out_ir->window_height = header.window_height;
+    out_ir->num_threads = header.num_threads;
+    out_ir->vsync = header.vsync;
+    out_ir->fullscreen = header.fullscreen;
+    out_ir->resizable = header.resizable;
+
+    // Same headroom as lowering from JSON
+    out_ir->node_cap = node_count + 128;
+    out_ir->nodes = SF_ARENA_PUSH(arena, sf_ir_node, out_ir->node_cap);
+    sf_ir_user* user_pool = SF_ARENA_PUSH(arena, sf_ir_user, header.user_count ? header.user_count : 1);
+    if (!out_ir->nodes || !user_pool) goto corrupt;
+    memset(out_ir->nodes, 0, sizeof(sf_ir_node) * out_ir->node_cap);
+    char* dir = sf_path_get_dir(path, arena);
+
+    // 2. Expand the records; strings and constants stay in the loaded buffer
+    for (u32 i = 0; i < node_count; ++i) {
+        const sf_ir_bin_node* src = &nodes[i];
+        sf_ir_node* dst = &out_ir->nodes[i];
+        if (src->op >= header.op_count || src->id >= header.strings_size) goto corrupt;
+        if (src->loc_file != SF_IR_NONE && src->loc_file >= header.strings_size) goto corrupt;
+        if (src->sub_graph_path != SF_IR_NONE && src->sub_graph_path >= header.strings_size) goto corrupt;
+        if (!valid_info(&src->const_info) || !valid_info(&src->out_info)) goto corrupt;
+        if (src->domain_node_idx != SF_IR_NONE && src->domain_node_idx >= node_count) goto corrupt;
+        if (src->const_size > header.blob_size || src->const_offset > header.blob_size - src->const_size) goto corrupt;
+
+        dst->id = strings + src->id;
+        dst->type = op_types[src->op];
+        dst->loc.file = src->loc_file != SF_IR_NONE ? strings + src->loc_file : file_loc.file;
+        dst->loc.line = src->loc_line;
+        dst->loc.column = src->loc_column;
+        if (src->sub_graph_path != SF_IR_NONE) {
+            const char* sub = strings + src->sub_graph_path;
+            dst->sub_graph_path = src->relative_path ? sf_path_join(dir, sub, arena) : sub;
+        }
+        dst->domain_node_idx = src->domain_node_idx;
+        for (u32 p = 0; p < 4; ++p) {
+            if (src->inputs[p][0] != SF_IR_NONE && src->inputs[p][0] >= node_count) goto corrupt;
+            dst->inputs[p].src_node_idx = src->inputs[p][0];
+            dst->inputs[p].src_port_idx = src->inputs[p][1];
+        }
+        dst->resource_flags = src->resource_flags;
+        unpack_info(&src->const_info, &dst->const_info);
+        unpack_info(&src->out_info, &dst->out_info);
+        // The payload must be exactly what const_info describes, or later passes read past it
+        if (src->const_size && src->const_size != info_bytes(&dst->const_info)) goto corrupt;
+        dst->const_data = src->const_size ? blob + src->const_offset : NULL;
+
+        // 3. CSR users become linked lists threaded through one pool, in the saved order
+        u32 begin = user_offsets[i], end = user_offsets[i + 1];
+        if (begin > end || end > header.user_count) goto corrupt;
+        sf_ir_user** link = &dst->users;
+        for (u32 u = begin; u < end; ++u) {
+            if (users[u].node_idx >= node_count || users[u].port_idx >= 4) goto corrupt;
+            user_pool[u].node_idx = users[u].node_idx;
+            user_pool[u].port_idx = users[u].port_idx;
+            *link = &user_pool[u];
+            link = &user_pool[u].next;
+        }
+        *link = NULL;
+    }
+    out_ir->node_count = node_count;
+    return true;
+
+corrupt:
+    sf_compiler_diag_report(diag, file_loc, "Corrupt binary IR file");
+    return false;
+}
+
+bool sf_compile_load_ir(const char* path, sf_graph_ir* out_ir, sf_arena* arena, sf_compiler_diag* diag) {
+    sf_source_loc file_loc = { sf_arena_strdup(arena, path), 0, 0 };
+    sf_file_map map;
+    if (!sf_file_map_open(&map, path)) {
+        sf_compiler_diag_report(diag, file_loc, "Could not read file");
+        return false;
+    }
+    bool ok = load_mapped(map.data, map.size, path, file_loc, out_ir, arena, diag);
+    sf_file_map_close(&map);
+    return ok;
+}
@@ -17,6 +17,11 @@ bool sf_compile_load_json_ir(const char* json_path, sf_graph_ir* out_ir, sf_aren
         final_path = (char*)json_path;
     }
 
+    // Precompiled graphs are already lowered
+    if (strcmp(sf_path_get_ext(final_path), "sfir") == 0) {
+        return sf_compile_load_ir(final_path, out_ir, arena, diag);
+    }
+
     char* json_content = sf_file_read(final_path, arena);
     if (!json_content) {
         sf_source_loc loc = {sf_arena_strdup(arena, final_path), 0, 0};
@@ -24,6 +29,12 @@ bool sf_compile_load_json_ir(const char* json_path, sf_graph_ir* out_ir, sf_aren
         return false;
     }
 
+    // Fast path: lower straight from the text. Documents it does not handle (and broken ones,
+    // for the diagnostics) go through the AST below.
+    if (sf_pass_lower_stream(json_content, strlen(json_content), out_ir, arena, final_path, diag)) {
+        return true;
+    }
+
     // 1. Parse JSON -> AST (Source Tracking)
     sf_ast_graph* ast = sf_json_parse_graph(json_content, arena);
     if (!ast) {
@@ -25,6 +25,7 @@ typedef struct sf_pass_ctx {
     sf_graph_ir* ir;
     sf_arena* arena;
     const char* base_path;
+    const sf_compiler_options* options;
     
     // Results of topological sort
     sf_ir_node** sorted_nodes;
@@ -35,6 +36,12 @@ typedef struct sf_pass_ctx {
     u32 task_count;
     sf_bin_task_binding* bindings;
     u32 binding_count;
+
+    // Results of Scheduling
+    u64 peak_live_bytes;
+
+    // Results of Memory Planning
+    sf_memory_plan memory;
 } sf_pass_ctx;
 
 bool sf_pass_sort(sf_pass_ctx* ctx, sf_compiler_diag* diag);
@@ -55,6 +62,18 @@ typedef struct {
 // - Resolves Port Names to Indices
 bool sf_pass_lower(sf_ast_graph* ast, sf_graph_ir* out_ir, sf_arena* arena, const char* base_path, sf_compiler_diag* diag);
 
+// Building blocks shared with the streaming lowering: one 'data' attribute of a node, and the
+// import that provides a non-ISA node type (NULL if none does).
+bool sf_lower_node_attribute(sf_ir_node* dst, const char* key, const sf_json_value* val, const char* base_path, sf_arena* arena, sf_compiler_diag* diag);
+const char* sf_lower_find_import(const char* const* imports, size_t import_count, const char* type_name, const char* base_path, sf_arena* arena);
+
+// --- Pass: JSON -> IR (Streaming Lowering) ---
+// Lowers graph JSON in a single pass straight into the IR, without building a document
+// tree. Produces the same IR as sf_json_parse_graph + sf_pass_lower. Returns false without
+// reporting anything when the document uses a construct it does not handle (or is
+// malformed); the caller then takes the AST path, which also produces the diagnostics.
+bool sf_pass_lower_stream(const char* json, size_t json_size, sf_graph_ir* out_ir, sf_arena* arena, const char* base_path, sf_compiler_diag* diag);
+
 // --- Pass: Inline Subgraphs ---
 // Recursively expands SF_NODE_CALL into flattened nodes.
 // Handles port remapping and unique ID generation.
@@ -75,4 +94,38 @@ bool sf_pass_domain_split(sf_pass_ctx* ctx, sf_compiler_diag* diag);
 bool sf_pass_fuse(sf_pass_ctx* ctx, sf_compiler_diag* diag);
 bool sf_pass_liveness(sf_pass_ctx* ctx, sf_compiler_diag* diag);
 
+// --- Pass: Common Subexpression Elimination ---
+// Merges nodes computing the same value (same type, attributes and inputs) into one.
+bool sf_pass_cse(sf_pass_ctx* ctx, sf_compiler_diag* diag);
+
+// --- Pass: Dead Code Elimination ---
+// Removes nodes that no OUTPUT, INPUT or persistent resource depends on and compacts the
+// node array. Re-sorts when ctx->sorted_nodes was already built.
+bool sf_pass_dce(sf_pass_ctx* ctx, sf_compiler_diag* diag);
+
+// --- Pass: Algebraic Simplification ---
+// Applies the spec's algebraic_rules (x*1, x+0, x/1, x*0, x/c). Needs analyzed shapes
+// and re-sorts ctx->sorted_nodes after rewriting.
+bool sf_pass_algebra(sf_pass_ctx* ctx, sf_compiler_diag* diag);
+
+// --- Pass: Reassociation ---
+// Rebalances linear chains of an ASSOCIATIVE op into log-depth trees (skipped for F32 under
+// options->strict_fp). Re-sorts ctx->sorted_nodes when anything changed.
+bool sf_pass_reassociate(sf_pass_ctx* ctx, sf_compiler_diag* diag);
+
+// --- Pass: Constant Folding ---
+// Evaluates nodes with constant inputs (and shape queries over static shapes) at compile time,
+// rewriting them into CONST nodes. Needs analyzed shapes and ctx->sorted_nodes.
+bool sf_pass_fold(sf_pass_ctx* ctx, sf_compiler_diag* diag);
+
+// --- Pass: Scheduling ---
+// Reorders ctx->sorted_nodes (dependencies preserved) according to options->schedule:
+// either clustering nodes of the same domain and strategy (fewest task breaks) or
+// greedily minimizing the bytes of live intermediates.
+bool sf_pass_schedule(sf_pass_ctx* ctx, sf_compiler_diag* diag);
+
+// --- Pass: Memory Planning ---
+// Packs every runtime tensor into one aligned buffer, overlapping disjoint lifetimes.
+bool sf_pass_memplan(sf_pass_ctx* ctx, sf_compiler_diag* diag);
+
 #endif // SF_PASSES_H
@@ -6,35 +6,286 @@
 #include <stdlib.h>
 #include <string.h>
 
+// Minimal thread and mutex shim: C11 <threads.h> is missing on macOS and older MSVC
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <direct.h>
+#define sfc_mkdir(path) _mkdir(path)
+
+typedef HANDLE sfc_thread;
+typedef CRITICAL_SECTION sfc_mutex;
+#define SFC_THREAD_FUNC DWORD WINAPI
+
+static bool sfc_thread_start(sfc_thread* t, LPTHREAD_START_ROUTINE fn, void* arg) {
+    *t = CreateThread(NULL, 0, fn, arg, 0, NULL);
+    return *t != NULL;
+}
+static void sfc_thread_join(sfc_thread t) {
+    WaitForSingleObject(t, INFINITE);
+    CloseHandle(t);
+}
+static bool sfc_mutex_init(sfc_mutex* m) { InitializeCriticalSection(m); return true; }
+static void sfc_mutex_destroy(sfc_mutex* m) { DeleteCriticalSection(m); }
+static void sfc_mutex_lock(sfc_mutex* m) { EnterCriticalSection(m); }
+static void sfc_mutex_unlock(sfc_mutex* m) { LeaveCriticalSection(m); }
+#else
+#include <sys/stat.h>
+#include <pthread.h>
+#define sfc_mkdir(path) mkdir(path, 0755)
+
+typedef pthread_t sfc_thread;
+typedef pthread_mutex_t sfc_mutex;
+#define SFC_THREAD_FUNC void*
+
+static bool sfc_thread_start(sfc_thread* t, void* (*fn)(void*), void* arg) { return pthread_create(t, NULL, fn, arg) == 0; }
+static void sfc_thread_join(sfc_thread t) { pthread_join(t, NULL); }
+static bool sfc_mutex_init(sfc_mutex* m) { return pthread_mutex_init(m, NULL) == 0; }
+static void sfc_mutex_destroy(sfc_mutex* m) { pthread_mutex_destroy(m); }
+static void sfc_mutex_lock(sfc_mutex* m) { pthread_mutex_lock(m); }
+static void sfc_mutex_unlock(sfc_mutex* m) { pthread_mutex_unlock(m); }
+#endif
+
 void print_usage() {
     printf("SionFlow Cartridge Compiler (sfc) v1.3\n");
-    printf("Usage: sfc <input.mfapp|input.json> [output.sfc]\n");
+    printf("Usage: sfc <input.mfapp|input.json|input.sfir> [output.sfc] [options]\n");
+    printf("Options:\n");
+    printf("  --cache-dir <dir>   Reuse unchanged kernels from a persistent compilation cache\n");
+    printf("  -j <N>              Compile up to N kernels in parallel (default: 1)\n");
+    printf("  --emit-memplan      Add each kernel's packed memory plan as a '<kernel>.mem' section\n");
+    printf("  --schedule <mode>   'cluster' (fewest tasks, default) or 'min-memory' (lowest peak)\n");
+    printf("  --l1-cache <size>   Per-tile working set budget, e.g. 48k (default: 32k)\n");
+    printf("  --l2-cache <size>   Rows up to this size are never split (default: 1m)\n");
+    printf("  --emit-ir           Write the lowered graph as binary IR (.sfir) instead of a cartridge\n");
+    printf("  --strict-fp         Keep float results bit-exact (no reassociation or inexact rewrites)\n");
+    printf("  --share-constants   Store constants used by several kernels once in a shared pool\n");
+    printf("                      (loaders must resolve it with sf_const_pool_resolve)\n");
+}
+
+// Byte count with an optional k/m suffix; 0 on malformed input
+static u32 parse_size(const char* s) {
+    char* end = NULL;
+    unsigned long v = strtoul(s, &end, 10);
+    if (end == s) return 0;
+    if (*end == 'k' || *end == 'K') { v *= 1024; end++; }
+    else if (*end == 'm' || *end == 'M') { v *= 1024 * 1024; end++; }
+    if (*end != '\0' || v > UINT32_MAX) return 0;
+    return (u32)v;
+}
+
+#define SFC_ARENA_SIZE ((size_t)1024 * 1024 * 128) // 128MB per worker
+
+// Compiles one graph, loading it from the cache instead when nothing it depends on changed.
+static bool compile_kernel(const char* id, const char* path, const char* cache_dir, const sf_compiler_options* opts, sf_graph_ir* ir, sf_arena* arena, sf_compile_result* out) {
+    u64 key = 0;
+    bool cacheable = cache_dir && sf_compile_cache_key(path, opts, arena, &key);
+    if (cacheable && sf_compile_cache_load(cache_dir, key, ir, arena, out)) {
+        SF_LOG_INFO("Kernel \'%s\' is up to date (cache %016llx, peak %llu live bytes)", id, (unsigned long long)key, (unsigned long long)out->peak_live_bytes);
+        return true;
+    }
+
+    SF_LOG_INFO("Compiling kernel \'%s\'...", id);
+    sf_compiler_diag diag; sf_compiler_diag_init(&diag, arena);
+    if (!sf_compile_load_json(path, ir, arena, &diag)) return false;
+
+    if (!sf_compile_ex(ir, opts, arena, &diag, out)) return false;
+    if (cacheable && !sf_compile_cache_store(cache_dir, key, out, ir)) {
+        SF_LOG_INFO("Could not write cache entry for kernel \'%s\'", id);
+    }
+    return true;
+}
+
+// With 'emit_memplan' each program is followed by a RAW "<kernel>.mem" section holding its
+// memory plan. Off by default: no runtime reads it yet and it costs a section per kernel.
+static bool add_kernel_sections(sf_section_desc* sections, u32* section_count, const char* id, const sf_compile_result* result, bool emit_memplan, sf_arena* arena) {
+    u32 needed = emit_memplan ? 2 : 1;
+    if (*section_count + needed > SF_MAX_SECTIONS) {
+        SF_LOG_ERROR("Too many cartridge sections (max %d)", SF_MAX_SECTIONS);
+        return false;
+    }
+    sections[(*section_count)++] = (sf_section_desc){ id, SF_SECTION_PROGRAM, result->program, 0 };
+    if (emit_memplan) {
+        u32 plan_size = 0;
+        void* plan = sf_memory_plan_serialize(&result->memory, arena, &plan_size);
+        if (!plan) return false;
+        sections[(*section_count)++] = (sf_section_desc){ sf_arena_sprintf(arena, "%s.mem", id), SF_SECTION_RAW, plan, plan_size };
+    }
+    return true;
+}
+
+// --- Parallel Kernel Build ---
+// Kernels are independent, so each worker compiles into its own arena and diagnostics.
+// Results land in per-kernel slots, which keeps the cartridge section order deterministic.
+
+typedef struct {
+    const sf_compiler_manifest* manifest;
+    const char* cache_dir;
+    const sf_compiler_options* options;
+    sf_compile_result* results;
+    u32 next_kernel;
+    bool failed;
+    sfc_mutex lock;
+} sfc_build_queue;
+
+typedef struct {
+    sfc_build_queue* queue;
+    sf_arena* arena;
+    sf_arena own_arena;
+    void* backing;
+    sfc_thread thread;
+} sfc_worker;
+
+static bool build_queue_pop(sfc_build_queue* q, u32* out_idx) {
+    sfc_mutex_lock(&q->lock);
+    bool ok = !q->failed && q->next_kernel < q->manifest->kernel_count;
+    if (ok) *out_idx = q->next_kernel++;
+    sfc_mutex_unlock(&q->lock);
+    return ok;
+}
+
+static SFC_THREAD_FUNC worker_main(void* arg) {
+    sfc_worker* w = (sfc_worker*)arg;
+    sfc_build_queue* q = w->queue;
+    u32 idx;
+    while (build_queue_pop(q, &idx)) {
+        const sf_compiler_kernel_desc* k = &q->manifest->kernels[idx];
+        sf_graph_ir k_ir = {0};
+        if (!compile_kernel(k->id, k->path, q->cache_dir, q->options, &k_ir, w->arena, &q->results[idx])) {
+            sfc_mutex_lock(&q->lock);
+            q->failed = true;
+            sfc_mutex_unlock(&q->lock);
+        }
+    }
+    return 0;
+}
+
+// Worker 0 runs on the calling thread using 'arena'; the others get private arenas that
+// must outlive the returned programs (release them with free_workers after saving).
+static bool compile_kernels(const sf_compiler_manifest* manifest, const char* cache_dir, const sf_compiler_options* opts, u32 jobs, sf_compile_result* results, sf_arena* arena, sfc_worker** out_workers, u32* out_worker_count) {
+    sfc_build_queue queue = { .manifest = manifest, .cache_dir = cache_dir, .options = opts, .results = results };
+    u32 worker_count = jobs < manifest->kernel_count ? jobs : manifest->kernel_count;
+    if (worker_count == 0) worker_count = 1;
+    sfc_worker* workers = calloc(worker_count, sizeof(sfc_worker));
+    if (!workers) return false;
+    if (!sfc_mutex_init(&queue.lock)) {
+        free(workers);
+        return false;
+    }
+    workers[0].queue = &queue;
+    workers[0].arena = arena;
+
+    u32 started = 1;
+    for (; started < worker_count; ++started) {
+        sfc_worker* w = &workers[started];
+        w->queue = &queue;
+        w->backing = malloc(SFC_ARENA_SIZE);
+        if (!w->backing) break;
+        sf_arena_init(&w->own_arena, w->backing, SFC_ARENA_SIZE);
+        w->arena = &w->own_arena;
+        if (!sfc_thread_start(&w->thread, worker_main, w)) {
+            free(w->backing);
+            w->backing = NULL;
+            break;
+        }
+    }
+    if (started > 1) SF_LOG_INFO("Compiling %u kernels on %u workers", manifest->kernel_count, started);
+
+    worker_main(&workers[0]);
+    for (u32 i = 1; i < started; ++i) sfc_thread_join(workers[i].thread);
+    sfc_mutex_destroy(&queue.lock);
+
+    *out_workers = workers;
+    *out_worker_count = started;
+    return !queue.failed;
+}
+
+static void free_workers(sfc_worker* workers, u32 worker_count) {
+    if (!workers) return;
+    for (u32 i = 1; i < worker_count; ++i) free(workers[i].backing);
+    free(workers);
 }
 
 int main(int argc, char** argv) {
     sf_log_init();
     sf_log_set_global_level(SF_LOG_LEVEL_DEBUG);
 
-    if (argc < 2) {
+    const char* input_path = NULL;
+    const char* output_arg = NULL;
+    const char* cache_dir = NULL;
+    u32 jobs = 1;
+    bool emit_memplan = false;
+    bool emit_ir = false;
+    bool share_constants = false;
+    sf_compiler_options opts;
+    sf_compiler_options_init(&opts);
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--cache-dir") == 0 && i + 1 < argc) {
+            cache_dir = argv[++i];
+        } else if (strcmp(argv[i], "--emit-memplan") == 0) {
+            emit_memplan = true;
+        } else if (strcmp(argv[i], "--schedule") == 0 && i + 1 < argc) {
+            const char* mode = argv[++i];
+            if (strcmp(mode, "cluster") == 0) opts.schedule = SF_SCHEDULE_CLUSTER;
+            else if (strcmp(mode, "min-memory") == 0) opts.schedule = SF_SCHEDULE_MIN_MEMORY;
+            else {
+                print_usage();
+                return 1;
+            }
+        } else if ((strcmp(argv[i], "--l1-cache") == 0 || strcmp(argv[i], "--l2-cache") == 0) && i + 1 < argc) {
+            u32 bytes = parse_size(argv[i + 1]);
+            if (bytes == 0) {
+                print_usage();
+                return 1;
+            }
+            if (strcmp(argv[i], "--l1-cache") == 0) opts.l1_cache_bytes = bytes;
+            else opts.l2_cache_bytes = bytes;
+            i++;
+        } else if (strcmp(argv[i], "--emit-ir") == 0) {
+            emit_ir = true;
+        } else if (strcmp(argv[i], "--strict-fp") == 0) {
+            opts.strict_fp = true;
+        } else if (strcmp(argv[i], "--share-constants") == 0) {
+            share_constants = true;
+        } else if (strncmp(argv[i], "-j", 2) == 0) {
+            const char* n = argv[i][2] ? argv[i] + 2 : (i + 1 < argc ? argv[++i] : "");
+            char* end = NULL;
+            long parsed = strtol(n, &end, 10);
+            if (end == n || *end != '\0' || parsed < 1 || parsed > 1024) {
+                print_usage();
+                return 1;
+            }
+            jobs = (u32)parsed;
+        } else if (argv[i][0] == '-') {
+            print_usage();
+            return 1;
+        } else if (!input_path) {
+            input_path = argv[i];
+        } else if (!output_arg) {
+            output_arg = argv[i];
+        }
+    }
+
+    if (!input_path) {
         print_usage();
         return 1;
     }
+    if (cache_dir) sfc_mkdir(cache_dir); // Fails harmlessly if it already exists
 
-    const char* input_path = argv[1];
     char output_path[256];
-    if (argc >= 3) {
-        strncpy(output_path, argv[2], 255);
+    if (output_arg) {
+        strncpy(output_path, output_arg, 255);
     } else {
         strncpy(output_path, input_path, 250);
         char* ext = strrchr(output_path, '.');
         if (ext) *ext = '\0';
-        strcat(output_path, ".sfc");
+        strcat(output_path, emit_ir ? ".sfir" : ".sfc");
     }
 
-    size_t arena_size = 1024 * 1024 * 128; // 128MB
-    void* backing = malloc(arena_size);
+    void* backing = malloc(SFC_ARENA_SIZE);
     sf_arena arena;
-    sf_arena_init(&arena, backing, arena_size);
+    sf_arena_init(&arena, backing, SFC_ARENA_SIZE);
+    sfc_worker* workers = NULL;
+    u32 worker_count = 0;
 
     sf_section_desc sections[SF_MAX_SECTIONS];
     u32 section_count = 0;
@@ -43,26 +294,22 @@ int main(int argc, char** argv) {
     const char* ext = sf_path_get_ext(input_path);
     bool success = false;
 
-    if (strcmp(ext, "mfapp") == 0) {
+    if (emit_ir) {
+        // Precompiled subgraph library: lowered but not optimized, CALLs stay unresolved
+        sf_compiler_diag diag; sf_compiler_diag_init(&diag, &arena);
+        if (sf_compile_load_json(input_path, &app_ir, &arena, &diag)) {
+            success = sf_compile_save_ir(&app_ir, output_path);
+            if (success) SF_LOG_INFO("Wrote binary IR: %s (%zu nodes)", output_path, app_ir.node_count);
+            else SF_LOG_ERROR("Failed to write binary IR: %s", output_path);
+        }
+    } else if (strcmp(ext, "mfapp") == 0) {
         sf_compiler_manifest manifest;
         if (sf_compiler_load_manifest(input_path, &manifest, &arena)) {
-            success = true;
-            for (u32 i = 0; i < manifest.kernel_count; ++i) {
-                SF_LOG_INFO("Compiling kernel \'%s\'...", manifest.kernels[i].id);
-                sf_compiler_diag diag; sf_compiler_diag_init(&diag, &arena);
-                sf_graph_ir k_ir = {0};
-                if (sf_compile_load_json(manifest.kernels[i].path, &k_ir, &arena, &diag)) {
-                    sf_program* prog = sf_compile(&k_ir, &arena, &diag);
-                    if (prog) {
-                        sections[section_count++] = (sf_section_desc){ manifest.kernels[i].id, SF_SECTION_PROGRAM, prog, 0 };
-                    } else {
-                        success = false;
-                        break;
-                    }
-                } else {
-                    success = false;
-                    break;
-                }
+            sf_compile_result* results = SF_ARENA_PUSH(&arena, sf_compile_result, manifest.kernel_count + 1);
+            memset(results, 0, sizeof(sf_compile_result) * (manifest.kernel_count + 1));
+            success = compile_kernels(&manifest, cache_dir, &opts, jobs, results, &arena, &workers, &worker_count);
+            for (u32 i = 0; success && i < manifest.kernel_count; ++i) {
+                success = add_kernel_sections(sections, &section_count, manifest.kernels[i].id, &results[i], emit_memplan, &arena);
             }
             
             if (success) {
@@ -88,26 +335,28 @@ int main(int argc, char** argv) {
         }
     } else {
         SF_LOG_INFO("Compiling single graph %s...", input_path);
-        sf_compiler_diag diag;
-        sf_compiler_diag_init(&diag, &arena);
-        if (sf_compile_load_json(input_path, &app_ir, &arena, &diag)) {
-            sf_program* prog = sf_compile(&app_ir, &arena, &diag);
-            if (prog) {
-                sections[section_count++] = (sf_section_desc){ "main", SF_SECTION_PROGRAM, prog, 0 };
-                success = true;
-            }
+        sf_compile_result result;
+        if (compile_kernel("main", input_path, cache_dir, &opts, &app_ir, &arena, &result)) {
+            success = add_kernel_sections(sections, &section_count, "main", &result, emit_memplan, &arena);
         }
     }
 
-    if (success) {
-        if (!sf_compile_save_cartridge(output_path, &app_ir, sections, section_count)) {
+    if (success && !emit_ir) {
+        sf_const_pool_stats pool;
+        if (!sf_compile_save_cartridge_ex(output_path, &app_ir, sections, section_count, share_constants, &arena, &pool)) {
             SF_LOG_ERROR("Failed to save cartridge.");
             success = false;
         } else {
+            if (share_constants) {
+                SF_LOG_INFO("Shared constants: %u of %u tensors use %u pool entries, %llu -> %llu bytes",
+                    pool.shared_count, pool.constant_count, pool.pool_entry_count,
+                    (unsigned long long)pool.bytes_before, (unsigned long long)pool.bytes_after);
+            }
             SF_LOG_INFO("Successfully created cartridge: %s", output_path);
         }
     }
 
+    free_workers(workers, worker_count);
     free(backing);
     return success ? 0 : 1;
 }
@@ -0,0 +1,65 @@
+/**
+ * Task Planning Benchmark
+ * Compiles a generated elementwise chain (50k nodes by default) through sf_compile_ex and
+ * fails when it takes longer than the given budget. Register ownership and task binding
+ * lookups are constant time; a linear scan there makes this chain quadratic again.
+ *
+ * Usage: bench_task_plan [nodes] [budget_seconds]
+ */
+
+#include "sf_test.h"
+#include <sionflow/compiler/sf_compiler.h>
+#include <time.h>
+
+static bool write_chain(const char* path, u32 count) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+
+    fprintf(f, "{\"nodes\":[\n{\"id\":\"x\",\"type\":\"INPUT\",\"data\":{\"shape\":[64],\"dtype\":\"f32\"}}");
+    for (u32 i = 0; i < count; ++i) {
+        fprintf(f, ",\n{\"id\":\"n%u\",\"type\":\"%s\"}", i, (i & 1) ? "MUL" : "ADD");
+    }
+    fprintf(f, ",\n{\"id\":\"out\",\"type\":\"OUTPUT\"}\n],\"links\":[\n");
+
+    for (u32 i = 0; i < count; ++i) {
+        if (i == 0) fprintf(f, "{\"src\":\"x\",\"dst\":\"n0\",\"dst_port\":\"a\"},\n");
+        else fprintf(f, "{\"src\":\"n%u\",\"dst\":\"n%u\",\"dst_port\":\"a\"},\n", i - 1, i);
+        fprintf(f, "{\"src\":\"x\",\"dst\":\"n%u\",\"dst_port\":\"b\"},\n", i);
+    }
+    fprintf(f, "{\"src\":\"n%u\",\"dst\":\"out\",\"dst_port\":\"in\"}\n]}\n", count - 1);
+
+    return fclose(f) == 0;
+}
+
+int main(int argc, char** argv) {
+    u32 count = argc > 1 ? (u32)strtoul(argv[1], NULL, 10) : 50000;
+    double budget = argc > 2 ? strtod(argv[2], NULL) : 30.0;
+    if (count == 0) count = 1;
+
+    const char* path = "bench_task_plan_chain.json";
+    if (!write_chain(path, count)) {
+        fprintf(stderr, "cannot write %s\n", path);
+        return 1;
+    }
+
+    sf_arena arena;
+    void* backing = sf_test_arena_init(&arena);
+    sf_compiler_diag diag;
+    sf_compiler_diag_init(&diag, &arena);
+
+    sf_graph_ir ir = {0};
+    clock_t start = clock();
+    bool loaded = sf_compile_load_json(path, &ir, &arena, &diag);
+    SF_CHECK(loaded);
+
+    sf_compile_result result = {0};
+    if (loaded) SF_CHECK(sf_compile_ex(&ir, NULL, &arena, &diag, &result));
+    double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("bench_task_plan: %u nodes compiled in %.3f s (budget %.1f s)\n", count, seconds, budget);
+    SF_CHECK(seconds <= budget);
+
+    remove(path);
+    free(backing);
+    return sf_test_finish("bench_task_plan");
+}
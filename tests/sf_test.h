@@ -0,0 +1,53 @@
+#ifndef SF_TEST_H
+#define SF_TEST_H
+
+/**
+ * Minimal test harness for the compiler tests: one executable per test, failures are
+ * printed with their location and turned into a non-zero exit code.
+ */
+
+#include <sionflow/base/sf_memory.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SF_TEST_ARENA_SIZE ((size_t)1024 * 1024 * 256)
+
+static int sf_test_failures = 0;
+
+#define SF_CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            sf_test_failures++; \
+        } \
+    } while (0)
+
+#define SF_CHECK_EQ_INT(a, b) \
+    do { \
+        long long sf_a_ = (long long)(a), sf_b_ = (long long)(b); \
+        if (sf_a_ != sf_b_) { \
+            fprintf(stderr, "%s:%d: %s == %s failed (%lld vs %lld)\n", __FILE__, __LINE__, #a, #b, sf_a_, sf_b_); \
+            sf_test_failures++; \
+        } \
+    } while (0)
+
+static inline void* sf_test_arena_init(sf_arena* arena) {
+    void* backing = malloc(SF_TEST_ARENA_SIZE);
+    if (!backing) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    sf_arena_init(arena, backing, SF_TEST_ARENA_SIZE);
+    return backing;
+}
+
+static inline int sf_test_finish(const char* name) {
+    if (sf_test_failures) {
+        fprintf(stderr, "%s: %d check(s) failed\n", name, sf_test_failures);
+        return 1;
+    }
+    printf("%s: ok\n", name);
+    return 0;
+}
+
+#endif // SF_TEST_H
@@ -0,0 +1,57 @@
+#ifndef SF_TEST_GRAPH_H
+#define SF_TEST_GRAPH_H
+
+/**
+ * Graph construction helpers for pass tests. Nodes are created with their analyzed
+ * out_info already filled in, so individual passes can run without the full pipeline.
+ */
+
+#include "sf_test.h"
+#include "sf_passes.h"
+#include "sf_graph_utils.h"
+#include <string.h>
+
+#define SF_TEST_NONE UINT32_MAX
+
+static inline void sf_test_graph_init(sf_graph_ir* ir, sf_arena* arena, size_t capacity) {
+    memset(ir, 0, sizeof(sf_graph_ir));
+    sf_ir_graph_reserve(ir, arena, capacity);
+}
+
+// Adds a node of 'n' elements (0 for a scalar) fed by up to three sources on ports 0..2
+static inline u32 sf_test_node(sf_graph_ir* ir, sf_arena* arena, const char* id, sf_node_type type, sf_dtype dtype, i32 n, u32 a, u32 b, u32 c) {
+    sf_ir_node* node = sf_ir_node_add(ir, arena, id, type);
+    node->out_info.dtype = dtype;
+    node->out_info.ndim = n ? 1 : 0;
+    node->out_info.shape[0] = n;
+    u32 idx = (u32)(node - ir->nodes);
+    u32 srcs[3] = { a, b, c };
+    for (u32 k = 0; k < 3; ++k) {
+        if (srcs[k] != SF_TEST_NONE) sf_builder_connect(ir, arena, (sf_port){ srcs[k], 0 }, (sf_port){ idx, k });
+    }
+    return idx;
+}
+
+static inline u32 sf_test_const_f32(sf_graph_ir* ir, sf_arena* arena, const char* id, const f32* values, i32 n) {
+    u32 idx = sf_test_node(ir, arena, id, SF_NODE_CONST, SF_DTYPE_F32, n, SF_TEST_NONE, SF_TEST_NONE, SF_TEST_NONE);
+    sf_ir_node* node = &ir->nodes[idx];
+    size_t count = n ? (size_t)n : 1;
+    f32* data = SF_ARENA_PUSH(arena, f32, count);
+    memcpy(data, values, sizeof(f32) * count);
+    node->const_info = node->out_info;
+    node->const_data = data;
+    return idx;
+}
+
+static inline f32 sf_test_const_at(const sf_graph_ir* ir, u32 idx, size_t i) {
+    return ((const f32*)ir->nodes[idx].const_data)[i];
+}
+
+static inline void sf_test_ctx_init(sf_pass_ctx* ctx, sf_graph_ir* ir, sf_arena* arena, const sf_compiler_options* opts) {
+    memset(ctx, 0, sizeof(sf_pass_ctx));
+    ctx->ir = ir;
+    ctx->arena = arena;
+    ctx->options = opts;
+}
+
+#endif // SF_TEST_GRAPH_H
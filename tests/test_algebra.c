@@ -0,0 +1,90 @@
+/**
+ * Algebraic Simplification Tests
+ * Runs sf_pass_algebra with the spec's rules: identities forward their operand, x*0
+ * materializes a zero constant, and x/c becomes x*(1/c) only for normal reciprocals.
+ */
+
+#include "sf_test_graph.h"
+
+static sf_arena arena;
+
+static void run_algebra(sf_graph_ir* ir) {
+    sf_compiler_options opts;
+    sf_compiler_options_init(&opts);
+    sf_compiler_diag diag;
+    sf_compiler_diag_init(&diag, &arena);
+    sf_pass_ctx ctx;
+    sf_test_ctx_init(&ctx, ir, &arena, &opts);
+    SF_CHECK(sf_pass_sort(&ctx, &diag));
+    SF_CHECK(sf_pass_algebra(&ctx, &diag));
+}
+
+// Builds x (4 elements) op c (scalar constant 'value') feeding an OUTPUT; returns the op
+static u32 binary_with_const(sf_graph_ir* ir, sf_node_type type, f32 value, u32* out_x, u32* out_sink) {
+    sf_test_graph_init(ir, &arena, 8);
+    u32 x = sf_test_node(ir, &arena, "x", SF_NODE_INPUT, SF_DTYPE_F32, 4, SF_TEST_NONE, SF_TEST_NONE, SF_TEST_NONE);
+    u32 c = sf_test_const_f32(ir, &arena, "c", &value, 0);
+    u32 op = sf_test_node(ir, &arena, "op", type, SF_DTYPE_F32, 4, x, c, SF_TEST_NONE);
+    *out_sink = sf_test_node(ir, &arena, "o", SF_NODE_OUTPUT, SF_DTYPE_F32, 4, op, SF_TEST_NONE, SF_TEST_NONE);
+    *out_x = x;
+    return op;
+}
+
+static void test_identities(void) {
+    const struct { sf_node_type type; f32 value; } cases[] = {
+        { SF_NODE_MUL, 1.0f }, { SF_NODE_ADD, 0.0f }, { SF_NODE_DIV, 1.0f },
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        sf_graph_ir ir;
+        u32 x, o;
+        u32 op = binary_with_const(&ir, cases[i].type, cases[i].value, &x, &o);
+        run_algebra(&ir);
+        SF_CHECK_EQ_INT(ir.nodes[op].type, SF_NODE_UNKNOWN);
+        SF_CHECK_EQ_INT(ir.nodes[o].inputs[0].src_node_idx, x);
+    }
+}
+
+static void test_mul_by_zero(void) {
+    sf_graph_ir ir;
+    u32 x, o;
+    u32 op = binary_with_const(&ir, SF_NODE_MUL, 0.0f, &x, &o);
+    run_algebra(&ir);
+    SF_CHECK_EQ_INT(ir.nodes[op].type, SF_NODE_CONST);
+    SF_CHECK_EQ_INT(ir.nodes[op].const_info.shape[0], 4);
+    for (size_t i = 0; i < 4; ++i) SF_CHECK(sf_test_const_at(&ir, op, i) == 0.0f);
+    SF_CHECK_EQ_INT(ir.nodes[o].inputs[0].src_node_idx, op);
+}
+
+static void test_reciprocal(void) {
+    sf_graph_ir ir;
+    u32 x, o;
+    u32 op = binary_with_const(&ir, SF_NODE_DIV, 4.0f, &x, &o);
+    run_algebra(&ir);
+    SF_CHECK_EQ_INT(ir.nodes[op].type, SF_NODE_MUL);
+    SF_CHECK_EQ_INT(ir.nodes[op].inputs[0].src_node_idx, x);
+    u32 r = ir.nodes[op].inputs[1].src_node_idx;
+    SF_CHECK(r != SF_TEST_NONE && ir.nodes[r].type == SF_NODE_CONST);
+    if (r != SF_TEST_NONE) SF_CHECK(sf_test_const_at(&ir, r, 0) == 0.25f);
+}
+
+// Zero divisors, reciprocals that overflow and subnormal reciprocals keep the division
+static void test_reciprocal_rejected(void) {
+    const f32 divisors[] = { 0.0f, 1e-39f, 1e38f };
+    for (size_t i = 0; i < sizeof(divisors) / sizeof(divisors[0]); ++i) {
+        sf_graph_ir ir;
+        u32 x, o;
+        u32 op = binary_with_const(&ir, SF_NODE_DIV, divisors[i], &x, &o);
+        run_algebra(&ir);
+        SF_CHECK_EQ_INT(ir.nodes[op].type, SF_NODE_DIV);
+    }
+}
+
+int main(void) {
+    void* backing = sf_test_arena_init(&arena);
+    test_identities();
+    test_mul_by_zero();
+    test_reciprocal();
+    test_reciprocal_rejected();
+    free(backing);
+    return sf_test_finish("test_algebra");
+}
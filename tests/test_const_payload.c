@@ -0,0 +1,123 @@
+/**
+ * Constant Payload Tests
+ * Loads CONST values from .npy and raw files through sf_ir_load_const_payload: shapes and
+ * dtypes come from the file when the node declares none, other element types are converted,
+ * and truncated or mismatching payloads are rejected.
+ */
+
+#include "sf_test_graph.h"
+#include "sf_compiler_internal.h"
+
+static sf_arena arena;
+
+// Writes a v1 .npy file; 'drop' bytes are cut from the end to simulate truncation
+static void write_npy(const char* path, const char* descr, const char* shape, const void* data, size_t bytes, size_t drop) {
+    char header[128];
+    int len = snprintf(header, sizeof(header), "{'descr': '%s', 'fortran_order': False, 'shape': %s, }", descr, shape);
+    size_t total = 10 + (size_t)len + 1;
+    size_t padded = (total + 63) / 64 * 64;
+    while ((size_t)len < padded - 10 - 1) header[len++] = ' ';
+    header[len++] = '\n';
+
+    FILE* f = fopen(path, "wb");
+    if (!f) return;
+    const u8 preamble[8] = { 0x93, 'N', 'U', 'M', 'P', 'Y', 1, 0 };
+    const u8 header_len[2] = { (u8)(len & 0xFF), (u8)(len >> 8) };
+    fwrite(preamble, 1, sizeof(preamble), f);
+    fwrite(header_len, 1, sizeof(header_len), f);
+    fwrite(header, 1, (size_t)len, f);
+    fwrite(data, 1, bytes - drop, f);
+    fclose(f);
+}
+
+static bool load(sf_ir_node* node, const char* ref_json, sf_dtype declared, sf_compiler_diag* diag) {
+    memset(node, 0, sizeof(*node));
+    node->id = "c";
+    node->type = SF_NODE_CONST;
+    node->const_info.dtype = declared;
+    node->out_info.dtype = declared;
+    sf_compiler_diag_init(diag, &arena);
+    sf_json_value* ref = sf_json_parse(ref_json, &arena);
+    SF_CHECK(ref != NULL);
+    return ref && sf_ir_load_const_payload(node, ref, NULL, &arena, diag);
+}
+
+static void test_npy_f32(void) {
+    const f32 values[6] = { 1, 2, 3, 4, 5, 6 };
+    write_npy("test_payload_f32.npy", "<f4", "(2, 3)", values, sizeof(values), 0);
+
+    sf_ir_node node;
+    sf_compiler_diag diag;
+    SF_CHECK(load(&node, "{\"path\": \"test_payload_f32.npy\"}", SF_DTYPE_UNKNOWN, &diag));
+    SF_CHECK_EQ_INT(node.const_info.dtype, SF_DTYPE_F32);
+    SF_CHECK_EQ_INT(node.const_info.ndim, 2);
+    SF_CHECK_EQ_INT(node.const_info.shape[0], 2);
+    SF_CHECK_EQ_INT(node.const_info.shape[1], 3);
+    SF_CHECK(node.const_data && memcmp(node.const_data, values, sizeof(values)) == 0);
+    remove("test_payload_f32.npy");
+}
+
+static void test_npy_f64_converted(void) {
+    const f64 values[3] = { 0.5, -1.25, 3.0 };
+    write_npy("test_payload_f64.npy", "<f8", "(3,)", values, sizeof(values), 0);
+
+    sf_ir_node node;
+    sf_compiler_diag diag;
+    SF_CHECK(load(&node, "{\"path\": \"test_payload_f64.npy\"}", SF_DTYPE_F32, &diag));
+    SF_CHECK_EQ_INT(node.const_info.shape[0], 3);
+    if (node.const_data) SF_CHECK(((const f32*)node.const_data)[1] == -1.25f);
+
+    // f64 has no IR dtype of its own: without a declared dtype the load fails
+    SF_CHECK(!load(&node, "{\"path\": \"test_payload_f64.npy\"}", SF_DTYPE_UNKNOWN, &diag));
+    remove("test_payload_f64.npy");
+}
+
+static void test_npy_truncated(void) {
+    const f32 values[4] = { 1, 2, 3, 4 };
+    write_npy("test_payload_short.npy", "<f4", "(4,)", values, sizeof(values), 4);
+
+    sf_ir_node node;
+    sf_compiler_diag diag;
+    SF_CHECK(!load(&node, "{\"path\": \"test_payload_short.npy\"}", SF_DTYPE_F32, &diag));
+    SF_CHECK(diag.error_count > 0);
+    remove("test_payload_short.npy");
+}
+
+static void test_raw_with_offset(void) {
+    const i32 values[3] = { 7, -8, 9 };
+    FILE* f = fopen("test_payload.bin", "wb");
+    SF_CHECK(f != NULL);
+    if (!f) return;
+    const u32 skipped = 0xDEADBEEF;
+    fwrite(&skipped, 1, sizeof(skipped), f);
+    fwrite(values, 1, sizeof(values), f);
+    fclose(f);
+
+    sf_ir_node node;
+    sf_compiler_diag diag;
+    SF_CHECK(load(&node, "{\"path\": \"test_payload.bin\", \"dtype\": \"i32\", \"offset\": 4}", SF_DTYPE_UNKNOWN, &diag));
+    SF_CHECK_EQ_INT(node.const_info.dtype, SF_DTYPE_I32);
+    SF_CHECK_EQ_INT(node.const_info.shape[0], 3);
+    if (node.const_data) SF_CHECK_EQ_INT(((const i32*)node.const_data)[1], -8);
+
+    // A declared shape must hold exactly the payload's elements
+    memset(&node, 0, sizeof(node));
+    node.id = "c";
+    node.const_info.dtype = SF_DTYPE_I32;
+    node.const_info.ndim = 1;
+    node.const_info.shape[0] = 4;
+    sf_compiler_diag_init(&diag, &arena);
+    sf_json_value* ref = sf_json_parse("{\"path\": \"test_payload.bin\", \"offset\": 4}", &arena);
+    SF_CHECK(ref && !sf_ir_load_const_payload(&node, ref, NULL, &arena, &diag));
+    remove("test_payload.bin");
+}
+
+int main(void) {
+    void* backing = sf_test_arena_init(&arena);
+    test_npy_f32();
+    test_npy_f64_converted();
+    test_npy_truncated();
+    test_raw_with_offset();
+    free(backing);
+    return sf_test_finish("test_const_payload");
+}
@@ -0,0 +1,119 @@
+/**
+ * Shared Constant Pool Tests
+ * Two kernels share a LUT and each has one private constant. Only the LUT moves into the
+ * "constants" section, the pooled programs resolve back to the original bytes, and corrupt or
+ * mismatching pools are rejected.
+ */
+
+#include "sf_test.h"
+#include "sf_compiler_internal.h"
+#include <string.h>
+
+static sf_arena arena;
+
+typedef struct {
+    sf_program prog;
+    sf_type_info infos[3];
+    void* data[3];
+} test_kernel;
+
+static const f32 LUT[8] = { 0, 1, 4, 9, 16, 25, 36, 49 };
+
+// Tensor 0: the shared LUT, 1: a private scalar, 2: a runtime value
+static void make_kernel(test_kernel* k, const f32* scalar) {
+    memset(k, 0, sizeof(*k));
+    k->infos[0] = (sf_type_info){ .dtype = SF_DTYPE_F32, .ndim = 1, .shape = { 8 } };
+    k->infos[1] = (sf_type_info){ .dtype = SF_DTYPE_F32, .ndim = 0 };
+    k->infos[2] = (sf_type_info){ .dtype = SF_DTYPE_F32, .ndim = 1, .shape = { 8 } };
+    k->data[0] = (void*)LUT;
+    k->data[1] = (void*)scalar;
+    k->prog.meta.tensor_count = 3;
+    k->prog.tensor_infos = k->infos;
+    k->prog.tensor_data = k->data;
+}
+
+static void test_share_and_resolve(void) {
+    static const f32 a_scale = 2.0f, b_scale = 3.0f;
+    test_kernel a, b;
+    make_kernel(&a, &a_scale);
+    make_kernel(&b, &b_scale);
+    sf_section_desc sections[2] = {
+        { "a", SF_SECTION_PROGRAM, &a.prog, 0 },
+        { "b", SF_SECTION_PROGRAM, &b.prog, 0 },
+    };
+
+    sf_section_desc* out = NULL;
+    u32 out_count = 0;
+    sf_const_pool_stats stats;
+    SF_CHECK(sf_const_pool_share(sections, 2, &arena, &out, &out_count, &stats));
+    SF_CHECK_EQ_INT(stats.constant_count, 4);
+    SF_CHECK_EQ_INT(stats.shared_count, 2);
+    SF_CHECK_EQ_INT(stats.pool_entry_count, 1);
+    SF_CHECK_EQ_INT(stats.bytes_before, 2 * sizeof(LUT) + 2 * sizeof(f32));
+    SF_CHECK_EQ_INT(stats.bytes_after, sizeof(LUT) + 2 * sizeof(f32));
+
+    // One extra section for the whole cartridge, not one per kernel
+    SF_CHECK_EQ_INT(out_count, 3);
+    if (out_count != 3) return;
+    SF_CHECK(strcmp(out[0].name, "constants") == 0 && out[0].type == SF_SECTION_RAW);
+    SF_CHECK(strcmp(out[1].name, "a") == 0 && strcmp(out[2].name, "b") == 0);
+
+    // The caller's programs are untouched; the written copies lose only the LUT
+    SF_CHECK(a.prog.tensor_data[0] == LUT);
+    for (u32 s = 1; s < 3; ++s) {
+        sf_program* prog = (sf_program*)out[s].data;
+        SF_CHECK(prog->tensor_data[0] == NULL);
+        SF_CHECK(prog->tensor_data[1] != NULL);
+        SF_CHECK(prog->tensor_data[2] == NULL);
+        SF_CHECK(sf_const_pool_resolve(out[0].data, out[0].size, out[s].name, prog));
+        SF_CHECK(prog->tensor_data[0] && memcmp(prog->tensor_data[0], LUT, sizeof(LUT)) == 0);
+        SF_CHECK(prog->tensor_data[0] != LUT);
+    }
+    SF_CHECK(*(const f32*)((sf_program*)out[2].data)->tensor_data[1] == b_scale);
+
+    // A program without a table is left alone
+    test_kernel c;
+    make_kernel(&c, &a_scale);
+    SF_CHECK(sf_const_pool_resolve(out[0].data, out[0].size, "c", &c.prog));
+    SF_CHECK(c.prog.tensor_data[0] == LUT);
+
+    // A table that does not fit the program, or a truncated pool, is an error
+    test_kernel d;
+    make_kernel(&d, &a_scale);
+    d.prog.tensor_data[0] = NULL;
+    d.prog.meta.tensor_count = 2;
+    SF_CHECK(!sf_const_pool_resolve(out[0].data, out[0].size, "a", &d.prog));
+    d.prog.meta.tensor_count = 3;
+    d.infos[0].shape[0] = 4;
+    SF_CHECK(!sf_const_pool_resolve(out[0].data, out[0].size, "a", &d.prog));
+    d.infos[0].shape[0] = 8;
+    SF_CHECK(!sf_const_pool_resolve(out[0].data, 16, "a", &d.prog));
+    SF_CHECK(!sf_const_pool_resolve(out[0].data, out[0].size - sizeof(LUT), "a", &d.prog));
+    SF_CHECK(d.prog.tensor_data[0] == NULL);
+}
+
+static void test_no_duplicates_unchanged(void) {
+    static const f32 a_scale = 2.0f;
+    static const f32 other[8] = { 1, 1, 1, 1, 1, 1, 1, 1 };
+    test_kernel a;
+    make_kernel(&a, &a_scale);
+    a.data[0] = (void*)other;
+    sf_section_desc sections[1] = { { "a", SF_SECTION_PROGRAM, &a.prog, 0 } };
+
+    sf_section_desc* out = NULL;
+    u32 out_count = 0;
+    sf_const_pool_stats stats;
+    SF_CHECK(sf_const_pool_share(sections, 1, &arena, &out, &out_count, &stats));
+    SF_CHECK(out == sections);
+    SF_CHECK_EQ_INT(out_count, 1);
+    SF_CHECK_EQ_INT(stats.pool_entry_count, 0);
+    SF_CHECK_EQ_INT(stats.bytes_before, stats.bytes_after);
+}
+
+int main(void) {
+    void* backing = sf_test_arena_init(&arena);
+    test_share_and_resolve();
+    test_no_duplicates_unchanged();
+    free(backing);
+    return sf_test_finish("test_const_pool");
+}
@@ -0,0 +1,78 @@
+/**
+ * Common Subexpression Elimination Tests
+ * Checks that duplicates merge across commutative operand order and equal constant
+ * contents, while non-commutative operand order and generators keep nodes apart.
+ */
+
+#include "sf_test_graph.h"
+
+static sf_arena arena;
+
+static void run_cse(sf_graph_ir* ir) {
+    sf_compiler_diag diag;
+    sf_compiler_diag_init(&diag, &arena);
+    sf_pass_ctx ctx;
+    sf_test_ctx_init(&ctx, ir, &arena, NULL);
+    SF_CHECK(sf_pass_cse(&ctx, &diag));
+}
+
+static void test_merge(void) {
+    sf_graph_ir ir;
+    sf_test_graph_init(&ir, &arena, 16);
+    const f32 two[1] = { 2 };
+    u32 x = sf_test_node(&ir, &arena, "x", SF_NODE_INPUT, SF_DTYPE_F32, 4, SF_TEST_NONE, SF_TEST_NONE, SF_TEST_NONE);
+    u32 y = sf_test_node(&ir, &arena, "y", SF_NODE_INPUT, SF_DTYPE_F32, 4, SF_TEST_NONE, SF_TEST_NONE, SF_TEST_NONE);
+    u32 c1 = sf_test_const_f32(&ir, &arena, "c1", two, 0);
+    u32 c2 = sf_test_const_f32(&ir, &arena, "c2", two, 0);
+    u32 a1 = sf_test_node(&ir, &arena, "a1", SF_NODE_ADD, SF_DTYPE_F32, 4, x, y, SF_TEST_NONE);
+    u32 a2 = sf_test_node(&ir, &arena, "a2", SF_NODE_ADD, SF_DTYPE_F32, 4, y, x, SF_TEST_NONE);
+    u32 m1 = sf_test_node(&ir, &arena, "m1", SF_NODE_MUL, SF_DTYPE_F32, 4, a1, c1, SF_TEST_NONE);
+    u32 m2 = sf_test_node(&ir, &arena, "m2", SF_NODE_MUL, SF_DTYPE_F32, 4, a2, c2, SF_TEST_NONE);
+    u32 d1 = sf_test_node(&ir, &arena, "d1", SF_NODE_DIV, SF_DTYPE_F32, 4, m1, x, SF_TEST_NONE);
+    u32 d2 = sf_test_node(&ir, &arena, "d2", SF_NODE_DIV, SF_DTYPE_F32, 4, x, m2, SF_TEST_NONE);
+    u32 r = sf_test_node(&ir, &arena, "r", SF_NODE_ADD, SF_DTYPE_F32, 4, d1, d2, SF_TEST_NONE);
+    sf_test_node(&ir, &arena, "o", SF_NODE_OUTPUT, SF_DTYPE_F32, 4, r, SF_TEST_NONE, SF_TEST_NONE);
+
+    run_cse(&ir);
+
+    // ADD(y, x) == ADD(x, y), equal constants merge, so both MULs collapse into m1
+    SF_CHECK_EQ_INT(ir.nodes[a2].type, SF_NODE_UNKNOWN);
+    SF_CHECK_EQ_INT(ir.nodes[c2].type, SF_NODE_UNKNOWN);
+    SF_CHECK_EQ_INT(ir.nodes[m2].type, SF_NODE_UNKNOWN);
+    SF_CHECK_EQ_INT(ir.nodes[m1].inputs[0].src_node_idx, a1);
+    SF_CHECK_EQ_INT(ir.nodes[m1].inputs[1].src_node_idx, c1);
+    // DIV is not commutative: m1 / x and x / m1 stay distinct
+    SF_CHECK_EQ_INT(ir.nodes[d1].type, SF_NODE_DIV);
+    SF_CHECK_EQ_INT(ir.nodes[d2].type, SF_NODE_DIV);
+    SF_CHECK_EQ_INT(ir.nodes[d2].inputs[1].src_node_idx, m1);
+}
+
+static void test_keep_generators_and_inputs(void) {
+    sf_graph_ir ir;
+    sf_test_graph_init(&ir, &arena, 8);
+    const f32 one[1] = { 1 };
+    const f32 other[1] = { 3 };
+    u32 i1 = sf_test_node(&ir, &arena, "i1", SF_NODE_INDEX_X, SF_DTYPE_F32, 4, SF_TEST_NONE, SF_TEST_NONE, SF_TEST_NONE);
+    u32 i2 = sf_test_node(&ir, &arena, "i2", SF_NODE_INDEX_X, SF_DTYPE_F32, 4, SF_TEST_NONE, SF_TEST_NONE, SF_TEST_NONE);
+    u32 x1 = sf_test_node(&ir, &arena, "x1", SF_NODE_INPUT, SF_DTYPE_F32, 4, SF_TEST_NONE, SF_TEST_NONE, SF_TEST_NONE);
+    u32 x2 = sf_test_node(&ir, &arena, "x2", SF_NODE_INPUT, SF_DTYPE_F32, 4, SF_TEST_NONE, SF_TEST_NONE, SF_TEST_NONE);
+    u32 c1 = sf_test_const_f32(&ir, &arena, "c1", one, 0);
+    u32 c2 = sf_test_const_f32(&ir, &arena, "c2", other, 0);
+
+    run_cse(&ir);
+
+    SF_CHECK_EQ_INT(ir.nodes[i1].type, SF_NODE_INDEX_X);
+    SF_CHECK_EQ_INT(ir.nodes[i2].type, SF_NODE_INDEX_X);
+    SF_CHECK_EQ_INT(ir.nodes[x1].type, SF_NODE_INPUT);
+    SF_CHECK_EQ_INT(ir.nodes[x2].type, SF_NODE_INPUT);
+    SF_CHECK_EQ_INT(ir.nodes[c1].type, SF_NODE_CONST);
+    SF_CHECK_EQ_INT(ir.nodes[c2].type, SF_NODE_CONST);
+}
+
+int main(void) {
+    void* backing = sf_test_arena_init(&arena);
+    test_merge();
+    test_keep_generators_and_inputs();
+    free(backing);
+    return sf_test_finish("test_cse");
+}
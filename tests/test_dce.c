@@ -0,0 +1,67 @@
+/**
+ * Dead Code Elimination Tests
+ * Checks that values no root reads are swept, that inputs and persistent resources stay,
+ * and that compaction keeps every link pointing at the right node.
+ */
+
+#include "sf_test_graph.h"
+
+static sf_arena arena;
+
+static u32 find_id(const sf_graph_ir* ir, const char* id) {
+    for (u32 i = 0; i < ir->node_count; ++i) {
+        if (ir->nodes[i].type != SF_NODE_UNKNOWN && strcmp(ir->nodes[i].id, id) == 0) return i;
+    }
+    return SF_TEST_NONE;
+}
+
+static void test_sweep_and_compact(void) {
+    sf_graph_ir ir;
+    sf_test_graph_init(&ir, &arena, 16);
+    const f32 two[1] = { 2 };
+    u32 x = sf_test_node(&ir, &arena, "x", SF_NODE_INPUT, SF_DTYPE_F32, 4, SF_TEST_NONE, SF_TEST_NONE, SF_TEST_NONE);
+    u32 d1 = sf_test_node(&ir, &arena, "d1", SF_NODE_MUL, SF_DTYPE_F32, 4, x, x, SF_TEST_NONE);
+    sf_test_node(&ir, &arena, "d2", SF_NODE_ADD, SF_DTYPE_F32, 4, d1, x, SF_TEST_NONE);
+    sf_test_node(&ir, &arena, "unused", SF_NODE_INPUT, SF_DTYPE_F32, 4, SF_TEST_NONE, SF_TEST_NONE, SF_TEST_NONE);
+    u32 c = sf_test_const_f32(&ir, &arena, "c", two, 0);
+    u32 p = sf_test_node(&ir, &arena, "state", SF_NODE_ADD, SF_DTYPE_F32, 4, x, c, SF_TEST_NONE);
+    ir.nodes[p].resource_flags |= SF_RESOURCE_FLAG_PERSISTENT;
+    u32 r = sf_test_node(&ir, &arena, "r", SF_NODE_MUL, SF_DTYPE_F32, 4, x, c, SF_TEST_NONE);
+    sf_test_node(&ir, &arena, "o", SF_NODE_OUTPUT, SF_DTYPE_F32, 4, r, SF_TEST_NONE, SF_TEST_NONE);
+
+    sf_compiler_diag diag;
+    sf_compiler_diag_init(&diag, &arena);
+    sf_pass_ctx ctx;
+    sf_test_ctx_init(&ctx, &ir, &arena, NULL);
+    SF_CHECK(sf_pass_dce(&ctx, &diag));
+
+    SF_CHECK_EQ_INT(ir.node_count, 6);
+    SF_CHECK_EQ_INT(find_id(&ir, "d1"), SF_TEST_NONE);
+    SF_CHECK_EQ_INT(find_id(&ir, "d2"), SF_TEST_NONE);
+    SF_CHECK(find_id(&ir, "unused") != SF_TEST_NONE);
+    SF_CHECK(find_id(&ir, "state") != SF_TEST_NONE);
+
+    // Links survive compaction
+    u32 nx = find_id(&ir, "x");
+    u32 nc = find_id(&ir, "c");
+    u32 nr = find_id(&ir, "r");
+    u32 no = find_id(&ir, "o");
+    SF_CHECK(nx != SF_TEST_NONE && nc != SF_TEST_NONE && nr != SF_TEST_NONE && no != SF_TEST_NONE);
+    if (nr == SF_TEST_NONE || no == SF_TEST_NONE) return;
+    SF_CHECK_EQ_INT(ir.nodes[nr].inputs[0].src_node_idx, nx);
+    SF_CHECK_EQ_INT(ir.nodes[nr].inputs[1].src_node_idx, nc);
+    SF_CHECK_EQ_INT(ir.nodes[no].inputs[0].src_node_idx, nr);
+    u32 users = 0;
+    for (sf_ir_user* u = ir.nodes[nx].users; u; u = u->next) {
+        SF_CHECK(u->node_idx < ir.node_count);
+        users++;
+    }
+    SF_CHECK_EQ_INT(users, 2); // state and r
+}
+
+int main(void) {
+    void* backing = sf_test_arena_init(&arena);
+    test_sweep_and_compact();
+    free(backing);
+    return sf_test_finish("test_dce");
+}
@@ -0,0 +1,93 @@
+/**
+ * Constant Folding Tests
+ * Runs sf_pass_fold on hand-built graphs and checks the folded values against the VM's
+ * arithmetic: F32 rounding after every op and a single rounding for FMA.
+ */
+
+#include "sf_test_graph.h"
+
+static sf_arena arena;
+
+static void run_fold(sf_graph_ir* ir, const sf_compiler_options* opts) {
+    sf_compiler_diag diag;
+    sf_compiler_diag_init(&diag, &arena);
+    sf_pass_ctx ctx;
+    sf_test_ctx_init(&ctx, ir, &arena, opts);
+    SF_CHECK(sf_pass_sort(&ctx, &diag));
+    SF_CHECK(sf_pass_fold(&ctx, &diag));
+}
+
+// mean-like chain: (a * b) summed, divided by SIZE(in), added to a runtime input
+static void test_chain(void) {
+    sf_graph_ir ir;
+    sf_test_graph_init(&ir, &arena, 16);
+    const f32 va[3] = { 1, 2, 3 };
+    const f32 vb[1] = { 2 };
+    u32 a = sf_test_const_f32(&ir, &arena, "a", va, 3);
+    u32 b = sf_test_const_f32(&ir, &arena, "b", vb, 0);
+    u32 in = sf_test_node(&ir, &arena, "in", SF_NODE_INPUT, SF_DTYPE_F32, 3, SF_TEST_NONE, SF_TEST_NONE, SF_TEST_NONE);
+    u32 m = sf_test_node(&ir, &arena, "m", SF_NODE_MUL, SF_DTYPE_F32, 3, a, b, SF_TEST_NONE);
+    u32 s = sf_test_node(&ir, &arena, "s", SF_NODE_REDUCE_SUM, SF_DTYPE_F32, 0, m, SF_TEST_NONE, SF_TEST_NONE);
+    u32 z = sf_test_node(&ir, &arena, "z", SF_NODE_SIZE, SF_DTYPE_F32, 0, in, SF_TEST_NONE, SF_TEST_NONE);
+    u32 d = sf_test_node(&ir, &arena, "d", SF_NODE_DIV, SF_DTYPE_F32, 0, s, z, SF_TEST_NONE);
+    u32 r = sf_test_node(&ir, &arena, "r", SF_NODE_ADD, SF_DTYPE_F32, 3, in, d, SF_TEST_NONE);
+    sf_test_node(&ir, &arena, "o", SF_NODE_OUTPUT, SF_DTYPE_F32, 3, r, SF_TEST_NONE, SF_TEST_NONE);
+
+    sf_compiler_options opts;
+    sf_compiler_options_init(&opts);
+    run_fold(&ir, &opts);
+
+    SF_CHECK_EQ_INT(ir.nodes[m].type, SF_NODE_CONST);
+    SF_CHECK(sf_test_const_at(&ir, m, 0) == 2.0f && sf_test_const_at(&ir, m, 2) == 6.0f);
+    SF_CHECK_EQ_INT(ir.nodes[z].type, SF_NODE_CONST);
+    SF_CHECK_EQ_INT(ir.nodes[d].type, SF_NODE_CONST);
+    SF_CHECK(sf_test_const_at(&ir, d, 0) == 4.0f);
+    // Folded nodes release their inputs; the runtime ADD keeps both links
+    SF_CHECK_EQ_INT(ir.nodes[d].inputs[0].src_node_idx, SF_TEST_NONE);
+    SF_CHECK_EQ_INT(ir.nodes[r].type, SF_NODE_ADD);
+    SF_CHECK_EQ_INT(ir.nodes[r].inputs[1].src_node_idx, d);
+}
+
+// (1 + 2^-12)^2 - (1 + 2^-11) is 2^-24 when fused, 0 when the product is rounded first
+static void test_fma_single_rounding(void) {
+    sf_graph_ir ir;
+    sf_test_graph_init(&ir, &arena, 8);
+    const f32 va[1] = { 1.0f + 0x1p-12f };
+    const f32 vc[1] = { -(1.0f + 0x1p-11f) };
+    u32 a = sf_test_const_f32(&ir, &arena, "a", va, 0);
+    u32 c = sf_test_const_f32(&ir, &arena, "c", vc, 0);
+    u32 f = sf_test_node(&ir, &arena, "f", SF_NODE_FMA, SF_DTYPE_F32, 0, a, a, c);
+    sf_test_node(&ir, &arena, "o", SF_NODE_OUTPUT, SF_DTYPE_F32, 0, f, SF_TEST_NONE, SF_TEST_NONE);
+
+    sf_compiler_options opts;
+    sf_compiler_options_init(&opts);
+    run_fold(&ir, &opts);
+
+    SF_CHECK_EQ_INT(ir.nodes[f].type, SF_NODE_CONST);
+    SF_CHECK(sf_test_const_at(&ir, f, 0) == 0x1p-24f);
+}
+
+static void test_disabled(void) {
+    sf_graph_ir ir;
+    sf_test_graph_init(&ir, &arena, 8);
+    const f32 v[1] = { 3 };
+    u32 a = sf_test_const_f32(&ir, &arena, "a", v, 0);
+    u32 m = sf_test_node(&ir, &arena, "m", SF_NODE_MUL, SF_DTYPE_F32, 0, a, a, SF_TEST_NONE);
+    sf_test_node(&ir, &arena, "o", SF_NODE_OUTPUT, SF_DTYPE_F32, 0, m, SF_TEST_NONE, SF_TEST_NONE);
+
+    sf_compiler_options opts;
+    sf_compiler_options_init(&opts);
+    opts.fold_max_bytes = 0;
+    run_fold(&ir, &opts);
+
+    SF_CHECK_EQ_INT(ir.nodes[m].type, SF_NODE_MUL);
+}
+
+int main(void) {
+    void* backing = sf_test_arena_init(&arena);
+    test_chain();
+    test_fma_single_rounding();
+    test_disabled();
+    free(backing);
+    return sf_test_finish("test_fold");
+}
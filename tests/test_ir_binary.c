@@ -0,0 +1,106 @@
+/**
+ * Binary IR Tests
+ * Saves a small graph as .sfir, loads it back and compares nodes, links and constants.
+ * A record whose const_size disagrees with its const_info must be rejected.
+ */
+
+#include "sf_test_graph.h"
+
+#define TEST_PATH "test_ir_binary.sfir"
+
+static sf_arena arena;
+
+static void build(sf_graph_ir* ir) {
+    sf_test_graph_init(ir, &arena, 8);
+    const f32 values[3] = { 1, 2, 3 };
+    u32 x = sf_test_node(ir, &arena, "x", SF_NODE_INPUT, SF_DTYPE_F32, 5, SF_TEST_NONE, SF_TEST_NONE, SF_TEST_NONE);
+    u32 c = sf_test_const_f32(ir, &arena, "c", values, 3);
+    ir->nodes[c].out_info.shape[0] = 7; // The only 3-element info is c's const_info, patched below
+    u32 m = sf_test_node(ir, &arena, "m", SF_NODE_MUL, SF_DTYPE_F32, 5, x, c, SF_TEST_NONE);
+    u32 a = sf_test_node(ir, &arena, "a", SF_NODE_ADD, SF_DTYPE_F32, 5, m, x, SF_TEST_NONE);
+    sf_test_node(ir, &arena, "o", SF_NODE_OUTPUT, SF_DTYPE_F32, 5, a, SF_TEST_NONE, SF_TEST_NONE);
+    ir->nodes[a].domain_node_idx = x;
+    strcpy(ir->app_title, "round trip");
+    ir->window_width = 640;
+}
+
+static void test_round_trip(void) {
+    sf_graph_ir ir;
+    build(&ir);
+    SF_CHECK(sf_compile_save_ir(&ir, TEST_PATH));
+
+    sf_graph_ir back;
+    sf_compiler_diag diag;
+    sf_compiler_diag_init(&diag, &arena);
+    SF_CHECK(sf_compile_load_ir(TEST_PATH, &back, &arena, &diag));
+    if (diag.error_count) return;
+
+    SF_CHECK(strcmp(back.app_title, "round trip") == 0);
+    SF_CHECK_EQ_INT(back.window_width, 640);
+    SF_CHECK_EQ_INT(back.node_count, ir.node_count);
+    for (size_t i = 0; i < ir.node_count && i < back.node_count; ++i) {
+        const sf_ir_node* a = &ir.nodes[i];
+        const sf_ir_node* b = &back.nodes[i];
+        SF_CHECK(strcmp(a->id, b->id) == 0);
+        SF_CHECK_EQ_INT(a->type, b->type);
+        SF_CHECK_EQ_INT(a->domain_node_idx, b->domain_node_idx);
+        SF_CHECK_EQ_INT(a->out_info.dtype, b->out_info.dtype);
+        SF_CHECK_EQ_INT(a->out_info.ndim, b->out_info.ndim);
+        SF_CHECK_EQ_INT(a->out_info.shape[0], b->out_info.shape[0]);
+        for (u32 k = 0; k < 4; ++k) SF_CHECK_EQ_INT(a->inputs[k].src_node_idx, b->inputs[k].src_node_idx);
+        u32 users_a = 0, users_b = 0;
+        for (const sf_ir_user* u = a->users; u; u = u->next) users_a++;
+        for (const sf_ir_user* u = b->users; u; u = u->next) users_b++;
+        SF_CHECK_EQ_INT(users_a, users_b);
+    }
+    const sf_ir_node* c = &back.nodes[1];
+    SF_CHECK(c->const_data != NULL);
+    if (c->const_data) {
+        SF_CHECK_EQ_INT(c->const_info.shape[0], 3);
+        SF_CHECK(((const f32*)c->const_data)[2] == 3.0f);
+    }
+}
+
+// Grows the saved const_info of 'c' from 3 to 4 elements without touching const_size
+static void test_const_size_mismatch(void) {
+    sf_graph_ir ir;
+    build(&ir);
+    SF_CHECK(sf_compile_save_ir(&ir, TEST_PATH));
+
+    FILE* f = fopen(TEST_PATH, "rb");
+    SF_CHECK(f != NULL);
+    if (!f) return;
+    static u8 data[1 << 16];
+    size_t size = fread(data, 1, sizeof(data), f);
+    fclose(f);
+
+    const u8 pattern[8] = { (u8)SF_DTYPE_F32, 1, 0, 0, 3, 0, 0, 0 }; // dtype, ndim, reserved, shape[0] (little endian)
+    bool patched = false;
+    for (size_t i = 0; i + sizeof(pattern) <= size && !patched; ++i) {
+        if (memcmp(data + i, pattern, sizeof(pattern)) == 0) {
+            data[i + 4] = 4;
+            patched = true;
+        }
+    }
+    SF_CHECK(patched);
+    f = fopen(TEST_PATH, "wb");
+    SF_CHECK(f != NULL);
+    if (!f) return;
+    fwrite(data, 1, size, f);
+    fclose(f);
+
+    sf_graph_ir back;
+    sf_compiler_diag diag;
+    sf_compiler_diag_init(&diag, &arena);
+    SF_CHECK(!sf_compile_load_ir(TEST_PATH, &back, &arena, &diag));
+    SF_CHECK(diag.error_count > 0);
+}
+
+int main(void) {
+    void* backing = sf_test_arena_init(&arena);
+    test_round_trip();
+    test_const_size_mismatch();
+    remove(TEST_PATH);
+    free(backing);
+    return sf_test_finish("test_ir_binary");
+}
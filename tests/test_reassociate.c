@@ -0,0 +1,91 @@
+/**
+ * Reassociation Tests
+ * An 8-operand ADD chain must become a depth-3 tree with its operands in order, F32 chains
+ * must stay linear under strict_fp, and strict_fp keeps algebraic rewrites bit-exact.
+ */
+
+#include "sf_test_graph.h"
+
+static sf_arena arena;
+
+static u32 tree_depth(const sf_graph_ir* ir, u32 idx) {
+    const sf_ir_node* node = &ir->nodes[idx];
+    if (node->type != SF_NODE_ADD) return 0;
+    u32 a = tree_depth(ir, node->inputs[0].src_node_idx);
+    u32 b = tree_depth(ir, node->inputs[1].src_node_idx);
+    return 1 + (a > b ? a : b);
+}
+
+// Appends the chain's leaves left to right
+static void tree_leaves(const sf_graph_ir* ir, u32 idx, u32* out, u32* count) {
+    const sf_ir_node* node = &ir->nodes[idx];
+    if (node->type != SF_NODE_ADD) { out[(*count)++] = idx; return; }
+    tree_leaves(ir, node->inputs[0].src_node_idx, out, count);
+    tree_leaves(ir, node->inputs[1].src_node_idx, out, count);
+}
+
+static void test_chain(bool strict_fp, sf_dtype dtype, u32 expected_depth) {
+    sf_graph_ir ir;
+    sf_test_graph_init(&ir, &arena, 32);
+    const char* names[8] = { "x0", "x1", "x2", "x3", "x4", "x5", "x6", "x7" };
+    u32 in[8];
+    for (u32 i = 0; i < 8; ++i) in[i] = sf_test_node(&ir, &arena, names[i], SF_NODE_INPUT, dtype, 4, SF_TEST_NONE, SF_TEST_NONE, SF_TEST_NONE);
+    u32 acc = in[0];
+    for (u32 i = 1; i < 8; ++i) acc = sf_test_node(&ir, &arena, "add", SF_NODE_ADD, dtype, 4, acc, in[i], SF_TEST_NONE);
+    u32 o = sf_test_node(&ir, &arena, "o", SF_NODE_OUTPUT, dtype, 4, acc, SF_TEST_NONE, SF_TEST_NONE);
+
+    sf_compiler_options opts;
+    sf_compiler_options_init(&opts);
+    opts.strict_fp = strict_fp;
+    sf_compiler_diag diag;
+    sf_compiler_diag_init(&diag, &arena);
+    sf_pass_ctx ctx;
+    sf_test_ctx_init(&ctx, &ir, &arena, &opts);
+    SF_CHECK(sf_pass_sort(&ctx, &diag));
+    SF_CHECK(sf_pass_reassociate(&ctx, &diag));
+
+    u32 root = ir.nodes[o].inputs[0].src_node_idx;
+    SF_CHECK_EQ_INT(tree_depth(&ir, root), expected_depth);
+    u32 leaves[8];
+    u32 leaf_count = 0;
+    tree_leaves(&ir, root, leaves, &leaf_count);
+    SF_CHECK_EQ_INT(leaf_count, 8);
+    for (u32 i = 0; i < leaf_count && i < 8; ++i) SF_CHECK_EQ_INT(leaves[i], in[i]);
+}
+
+// Returns the type of the node feeding the output after algebra on x 'type' c
+static sf_node_type strict_algebra(sf_node_type type, f32 value) {
+    sf_graph_ir ir;
+    sf_test_graph_init(&ir, &arena, 8);
+    u32 x = sf_test_node(&ir, &arena, "x", SF_NODE_INPUT, SF_DTYPE_F32, 4, SF_TEST_NONE, SF_TEST_NONE, SF_TEST_NONE);
+    u32 c = sf_test_const_f32(&ir, &arena, "c", &value, 0);
+    u32 op = sf_test_node(&ir, &arena, "op", type, SF_DTYPE_F32, 4, x, c, SF_TEST_NONE);
+    u32 o = sf_test_node(&ir, &arena, "o", SF_NODE_OUTPUT, SF_DTYPE_F32, 4, op, SF_TEST_NONE, SF_TEST_NONE);
+
+    sf_compiler_options opts;
+    sf_compiler_options_init(&opts);
+    opts.strict_fp = true;
+    sf_compiler_diag diag;
+    sf_compiler_diag_init(&diag, &arena);
+    sf_pass_ctx ctx;
+    sf_test_ctx_init(&ctx, &ir, &arena, &opts);
+    SF_CHECK(sf_pass_sort(&ctx, &diag));
+    SF_CHECK(sf_pass_algebra(&ctx, &diag));
+    return ir.nodes[ir.nodes[o].inputs[0].src_node_idx].type;
+}
+
+int main(void) {
+    void* backing = sf_test_arena_init(&arena);
+    test_chain(false, SF_DTYPE_F32, 3);
+    test_chain(true, SF_DTYPE_F32, 7);
+    test_chain(true, SF_DTYPE_I32, 3);
+
+    SF_CHECK_EQ_INT(strict_algebra(SF_NODE_ADD, 0.0f), SF_NODE_ADD); // -0 + 0 is +0
+    SF_CHECK_EQ_INT(strict_algebra(SF_NODE_MUL, 0.0f), SF_NODE_MUL); // NaN * 0 is NaN
+    SF_CHECK_EQ_INT(strict_algebra(SF_NODE_DIV, 3.0f), SF_NODE_DIV); // 1/3 is inexact
+    SF_CHECK_EQ_INT(strict_algebra(SF_NODE_DIV, 4.0f), SF_NODE_MUL);
+    SF_CHECK_EQ_INT(strict_algebra(SF_NODE_MUL, 1.0f), SF_NODE_INPUT);
+
+    free(backing);
+    return sf_test_finish("test_reassociate");
+}
@@ -3,6 +3,7 @@ set(SOURCE_PATH "${CMAKE_CURRENT_LIST_DIR}/../../../sf-compiler")
 vcpkg_cmake_configure(
     SOURCE_PATH "${SOURCE_PATH}"
     GENERATOR "Ninja"
+    OPTIONS -DSF_COMPILER_BUILD_TESTS=OFF
 )
 
 vcpkg_cmake_install()